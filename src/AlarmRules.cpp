@@ -0,0 +1,107 @@
+#include "AlarmRules.h"
+#include "Channels.h"
+#include "text_utils.h"
+
+// Config rule flattened so the per-sample check is four compares with no flag tests:
+// disabled bounds sit far outside any int16 config value.
+struct CompiledAlarm {
+  int32_t warnLow;
+  int32_t warnHigh;
+  int32_t critLow;
+  int32_t critHigh;
+  int32_t hysteresis;
+  uint32_t debounceMs;
+};
+
+// Ingest-side state per channel
+struct AlarmState {
+  uint8_t severity;       // Committed severity, published with the channel
+  uint8_t pending;        // Latest classification, waiting out the debounce
+  uint32_t pendingSinceMs;
+};
+
+#define ALARM_BOUND_OFF_LOW  INT32_MIN / 2
+#define ALARM_BOUND_OFF_HIGH INT32_MAX / 2
+
+static CompiledAlarm compiledAlarms[CHANNEL_COUNT];
+static AlarmState alarmStates[CHANNEL_COUNT];
+
+void compileAlarmRule(uint8_t channel) {
+  if (channel >= CHANNEL_COUNT) {
+    return;
+  }
+  const AlarmRuleConfig &rule = currentDisplayConfig.alarms[channel];
+  CompiledAlarm compiled;
+  compiled.warnLow = (rule.flags & ALARM_WARN_LOW) ? rule.warnLow : ALARM_BOUND_OFF_LOW;
+  compiled.warnHigh = (rule.flags & ALARM_WARN_HIGH) ? rule.warnHigh : ALARM_BOUND_OFF_HIGH;
+  compiled.critLow = (rule.flags & ALARM_CRIT_LOW) ? rule.critLow : ALARM_BOUND_OFF_LOW;
+  compiled.critHigh = (rule.flags & ALARM_CRIT_HIGH) ? rule.critHigh : ALARM_BOUND_OFF_HIGH;
+  compiled.hysteresis = rule.hysteresis;
+  compiled.debounceMs = rule.debounceMs;
+  compiledAlarms[channel] = compiled;
+}
+
+void compileAlarmRules() {
+  for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+    compileAlarmRule(i);
+  }
+}
+
+// Bands we're already in are widened by the hysteresis, so a value hovering
+// on a bound doesn't flip the color every sample
+static uint8_t classify(const CompiledAlarm &alarm, int32_t value, uint8_t current) {
+  int32_t hold = (current >= SEVERITY_CRITICAL) ? alarm.hysteresis : 0;
+  if (value < alarm.critLow + hold || value > alarm.critHigh - hold) {
+    return SEVERITY_CRITICAL;
+  }
+  hold = (current >= SEVERITY_WARN) ? alarm.hysteresis : 0;
+  if (value < alarm.warnLow + hold || value > alarm.warnHigh - hold) {
+    return SEVERITY_WARN;
+  }
+  return SEVERITY_NORMAL;
+}
+
+// Called from writeChannel() for every sample; returns the severity to publish
+uint8_t updateAlarm(uint8_t channel, int32_t value, uint32_t nowMs) {
+  if (channel >= CHANNEL_COUNT) {
+    return SEVERITY_NORMAL;
+  }
+  AlarmState &state = alarmStates[channel];
+  uint8_t severity = classify(compiledAlarms[channel], value, state.severity);
+  if (severity != state.pending) {
+    state.pending = severity;
+    state.pendingSinceMs = nowMs;
+  }
+  if (severity != state.severity && nowMs - state.pendingSinceMs >= compiledAlarms[channel].debounceMs) {
+    state.severity = severity;
+  }
+  return state.severity;
+}
+
+// Rules in display units, e.g. "warnHigh":"95.0" for Coolant
+String getAlarmRulesJson() {
+  char buf[22];
+  String json = "[";
+  for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+    const AlarmRuleConfig &rule = currentDisplayConfig.alarms[i];
+    uint8_t decimals = channelInfo[i].decimals;
+    if (i > 0) json += ",";
+    json += "{\"dataSource\":" + String(i) + ",";
+    json += "\"name\":\"" + String(channelInfo[i].name) + "\",";
+    json += "\"flags\":" + String(rule.flags) + ",";
+    formatValue(buf, rule.warnLow, decimals);
+    json += "\"warnLow\":\"" + String(buf) + "\",";
+    formatValue(buf, rule.warnHigh, decimals);
+    json += "\"warnHigh\":\"" + String(buf) + "\",";
+    formatValue(buf, rule.critLow, decimals);
+    json += "\"critLow\":\"" + String(buf) + "\",";
+    formatValue(buf, rule.critHigh, decimals);
+    json += "\"critHigh\":\"" + String(buf) + "\",";
+    formatValue(buf, rule.hysteresis, decimals);
+    json += "\"hysteresis\":\"" + String(buf) + "\",";
+    json += "\"debounceMs\":" + String(rule.debounceMs) + ",";
+    json += "\"severity\":" + String(alarmStates[i].severity) + "}";
+  }
+  json += "]";
+  return json;
+}
@@ -0,0 +1,20 @@
+#ifndef ALARM_RULES_H
+#define ALARM_RULES_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "DisplayConfig.h"
+
+enum AlarmSeverity : uint8_t {
+  SEVERITY_NORMAL,
+  SEVERITY_WARN,
+  SEVERITY_CRITICAL
+};
+
+// Function declarations
+void compileAlarmRules();
+void compileAlarmRule(uint8_t channel);
+uint8_t updateAlarm(uint8_t channel, int32_t value, uint32_t nowMs);
+String getAlarmRulesJson();
+
+#endif // ALARM_RULES_H
@@ -1,6 +1,6 @@
 #include "BacklightControl.h"
 #include "Config.h"
-#include "DataTypes.h"
+#include "Telemetry.h"
 #include "Arduino.h"
 
 void setupBacklight() {
@@ -20,7 +20,7 @@ void adjustBacklightAutomatically() {
     uint8_t newBrightness = BACKLIGHT_BRIGHTNESS;
     
     // Reduce brightness when engine is running (RPM > 500)
-    if (rpm > 500) {
+    if (getChannelValue(DATA_SOURCE_RPM) > 500) {
       newBrightness = 80; // Dimmer when driving
     } else {
       newBrightness = 150; // Brighter when idle/parked
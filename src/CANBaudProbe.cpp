@@ -0,0 +1,54 @@
+#include "CANBaudProbe.h"
+
+void beginCANBaudSample(CANBaudSample &sample, uint32_t bitrate, uint32_t nowMs) {
+  sample.bitrate = bitrate;
+  sample.startMs = nowMs;
+  sample.validFrames = 0;
+  sample.errorFrames = 0;
+}
+
+// Count one event and decide whether the window can end early.
+// Events at or past CAN_BAUD_PROBE_WINDOW_MS are not counted.
+CANBaudStep stepCANBaudSample(CANBaudSample &sample, CANBaudEvent event, uint32_t nowMs) {
+  if (nowMs - sample.startMs >= CAN_BAUD_PROBE_WINDOW_MS) {
+    return CAN_BAUD_STEP_TIMEOUT;
+  }
+  if (event == CAN_BAUD_EVENT_FRAME && sample.validFrames < 0xFFFF) {
+    sample.validFrames++;
+  } else if (event == CAN_BAUD_EVENT_ERROR && sample.errorFrames < 0xFFFF) {
+    sample.errorFrames++;
+  }
+  if (isCANBaudSampleHopeless(sample)) {
+    return CAN_BAUD_STEP_HOPELESS;
+  }
+  if (isCANBaudSampleConclusive(sample)) {
+    return CAN_BAUD_STEP_CONCLUSIVE;
+  }
+  return CAN_BAUD_STEP_LISTEN;
+}
+
+// Enough clean traffic to stop probing the remaining candidates
+bool isCANBaudSampleConclusive(const CANBaudSample &sample) {
+  return sample.validFrames >= CAN_BAUD_MIN_VALID_FRAMES && sample.errorFrames == 0;
+}
+
+// A wrong bitrate shows up as a burst of stuff/form errors - no need to wait out the window
+bool isCANBaudSampleHopeless(const CANBaudSample &sample) {
+  return sample.errorFrames >= CAN_BAUD_MAX_ERRORS;
+}
+
+// Pick the candidate with valid frames and no error frames.
+// Ties go to the one with more valid frames. Returns -1 when nothing qualifies.
+int8_t selectCANBitrate(const CANBaudSample *samples, uint8_t count) {
+  int8_t best = -1;
+  for (uint8_t i = 0; i < count; i++) {
+    const CANBaudSample &s = samples[i];
+    if (s.errorFrames != 0 || s.validFrames < CAN_BAUD_MIN_VALID_FRAMES) {
+      continue;
+    }
+    if (best < 0 || s.validFrames > samples[best].validFrames) {
+      best = i;
+    }
+  }
+  return best;
+}
@@ -0,0 +1,41 @@
+#ifndef CAN_BAUD_PROBE_H
+#define CAN_BAUD_PROBE_H
+
+#include <stdint.h>
+
+// Probe tuning
+#define CAN_BAUD_PROBE_WINDOW_MS 150   // Max listen time per candidate bitrate
+#define CAN_BAUD_MIN_VALID_FRAMES 4    // Valid frames needed to trust a bitrate
+#define CAN_BAUD_MAX_ERRORS 8          // Bail out of a candidate early past this many bus errors
+
+// What one listen-only window at a given bitrate observed
+struct CANBaudSample {
+  uint32_t bitrate;
+  uint32_t startMs;
+  uint16_t validFrames;
+  uint16_t errorFrames;
+};
+
+// One thing the controller reported while listening
+enum CANBaudEvent {
+  CAN_BAUD_EVENT_IDLE,    // Nothing received, just time passing
+  CAN_BAUD_EVENT_FRAME,   // A frame passed CRC
+  CAN_BAUD_EVENT_ERROR    // One bus error (stuff, form, CRC)
+};
+
+// Where a sample stands after an event
+enum CANBaudStep {
+  CAN_BAUD_STEP_LISTEN,      // Keep feeding events
+  CAN_BAUD_STEP_CONCLUSIVE,  // Clean traffic, stop probing
+  CAN_BAUD_STEP_HOPELESS,    // Error burst, wrong bitrate
+  CAN_BAUD_STEP_TIMEOUT      // Window over without a verdict
+};
+
+// Pure decision logic, no hardware access - runs the same on the host
+void beginCANBaudSample(CANBaudSample &sample, uint32_t bitrate, uint32_t nowMs);
+CANBaudStep stepCANBaudSample(CANBaudSample &sample, CANBaudEvent event, uint32_t nowMs);
+bool isCANBaudSampleConclusive(const CANBaudSample &sample);
+bool isCANBaudSampleHopeless(const CANBaudSample &sample);
+int8_t selectCANBitrate(const CANBaudSample *samples, uint8_t count);
+
+#endif // CAN_BAUD_PROBE_H
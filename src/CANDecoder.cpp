@@ -0,0 +1,204 @@
+#include "CANDecoder.h"
+#include "Channels.h"
+#include "CANProtocols.h"
+#include "Arduino.h"
+
+// How a compiled step pulls its raw value out of the payload
+enum DecodeKind : uint8_t {
+  DECODE_BIT,       // (data[offset] >> shift) & 1
+  DECODE_BE16,      // Two bytes MSB first, the common Haltech case
+  DECODE_LE16,
+  DECODE_GENERIC,   // Any other length/endianness/sign, via extractRaw()
+};
+
+// A CANSignal compiled for the active protocol: extraction picked up front and the
+// target's fixed-point scale folded into mul/add where that is exact. CAN signals
+// only target the fixed decoded channels, whose decimals never change at runtime.
+struct DecodeStep {
+  uint8_t offset;
+  uint8_t end;          // offset + bytes read, checked against the frame length
+  uint8_t kind;         // DecodeKind
+  uint8_t shift;        // Bit index for DECODE_BIT, 16 for signed 16-bit reads
+  uint8_t target;
+  uint8_t decimals;     // Target decimals still to apply with scaleFixed(), 1 = none
+  uint16_t div;
+  int32_t mul;
+  int32_t add;
+  const CANSignal *signal;  // Source row, for DECODE_GENERIC
+};
+
+// Active protocol and its ID -> step range lookup, rebuilt on protocol change
+static const CANProtocol *activeProtocol = &canProtocols[CAN_PROTOCOL_HALTECH];
+static uint8_t activeProtocolIndex = CAN_PROTOCOL_HALTECH;
+static uint8_t firstSignal[CAN_DECODER_ID_SPAN];
+static uint8_t signalCount[CAN_DECODER_ID_SPAN];
+static DecodeStep steps[CAN_DECODER_MAX_SIGNALS];
+
+static DecodeStep compileSignal(const CANSignal &sig) {
+  DecodeStep step;
+  step.offset = sig.offset;
+  step.end = sig.offset + ((sig.flags & SIG_BIT) ? 1 : sig.length);
+  step.shift = 0;
+  step.target = sig.target;
+  step.decimals = 1;
+  step.div = sig.div;
+  step.mul = sig.mul;
+  step.add = sig.add;
+  step.signal = &sig;
+
+  if (sig.flags & SIG_BIT) {
+    step.kind = DECODE_BIT;
+    step.shift = sig.length;
+    return step;
+  }
+  if (sig.length == 2) {
+    step.kind = (sig.flags & SIG_BIG_ENDIAN) ? DECODE_BE16 : DECODE_LE16;
+    step.shift = (sig.flags & SIG_SIGNED) ? 16 : 0;
+  } else {
+    step.kind = DECODE_GENERIC;
+  }
+
+  // Tenths -> target decimals: fold into the integer scale when no rounding is lost
+  if (sig.target < CHANNEL_COUNT) {
+    uint8_t decimals = channelInfo[sig.target].decimals;
+    if (decimals == 0 && sig.div == 1 && sig.mul % 10 == 0 && sig.add % 10 == 0) {
+      step.mul = sig.mul / 10;
+      step.add = sig.add / 10;
+    } else if (decimals == 2 && sig.div == 1) {
+      step.mul = sig.mul * 10;
+      step.add = sig.add * 10;
+    } else {
+      step.decimals = decimals;
+    }
+  }
+  return step;
+}
+
+void initCANDecoder() {
+  selectCANProtocol(CAN_PROTOCOL_HALTECH);
+}
+
+void selectCANProtocol(uint8_t protocol) {
+  if (protocol >= CAN_PROTOCOL_COUNT) {
+    protocol = CAN_PROTOCOL_HALTECH;
+  }
+  activeProtocolIndex = protocol;
+  activeProtocol = &canProtocols[protocol];
+
+  memset(signalCount, 0, sizeof(signalCount));
+  uint8_t count = activeProtocol->signalCount;
+  if (count > CAN_DECODER_MAX_SIGNALS) {
+    Serial.printf("[CAN] %s has %u signals, decoding the first %u\n", activeProtocol->name, count, CAN_DECODER_MAX_SIGNALS);
+    count = CAN_DECODER_MAX_SIGNALS;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    steps[i] = compileSignal(activeProtocol->signals[i]);
+    uint32_t slot = activeProtocol->signals[i].id - activeProtocol->idBase;
+    if (slot >= CAN_DECODER_ID_SPAN) {
+      Serial.printf("[CAN] Signal ID 0x%03X outside decoder window, ignored\n", activeProtocol->signals[i].id);
+      continue;
+    }
+    if (signalCount[slot] == 0) {
+      firstSignal[slot] = i;
+    }
+    signalCount[slot]++;
+  }
+}
+
+uint8_t getCANProtocol() {
+  return activeProtocolIndex;
+}
+
+// Linear scan, only used while sniffing the bus for auto-detection
+bool protocolCarriesId(uint8_t protocol, uint32_t id) {
+  if (protocol >= CAN_PROTOCOL_COUNT) {
+    return false;
+  }
+  const CANProtocol &p = canProtocols[protocol];
+  for (uint8_t i = 0; i < p.signalCount; i++) {
+    if (p.signals[i].id == id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline int32_t extractRaw(const CANSignal &sig, const uint8_t *data) {
+  if (sig.flags & SIG_BIT) {
+    return (data[sig.offset] >> sig.length) & 0x01;
+  }
+
+  uint32_t raw = 0;
+  if (sig.flags & SIG_BIG_ENDIAN) {
+    for (uint8_t i = 0; i < sig.length; i++) {
+      raw = (raw << 8) | data[sig.offset + i];
+    }
+  } else {
+    for (uint8_t i = sig.length; i > 0; i--) {
+      raw = (raw << 8) | data[sig.offset + i - 1];
+    }
+  }
+
+  if ((sig.flags & SIG_SIGNED) && sig.length < 4) {
+    uint8_t shift = 32 - sig.length * 8;
+    return (int32_t)(raw << shift) >> shift;
+  }
+  return (int32_t)raw;
+}
+
+// Decode every signal carried by a frame. Returns false for IDs with no signals.
+bool decodeCANFrame(uint32_t id, const uint8_t *data, uint8_t length) {
+  uint32_t slot = id - activeProtocol->idBase;
+  if (slot >= CAN_DECODER_ID_SPAN || signalCount[slot] == 0) {
+    return false;
+  }
+
+  uint32_t now = millis();
+  const DecodeStep *step = &steps[firstSignal[slot]];
+  for (uint8_t i = signalCount[slot]; i > 0; i--, step++) {
+    if (step->end > length) {
+      continue;  // Short frame, leave the old value in place
+    }
+    int32_t raw;
+    switch (step->kind) {
+      case DECODE_BIT:
+        raw = (data[step->offset] >> step->shift) & 0x01;
+        break;
+      case DECODE_BE16:
+        raw = (data[step->offset] << 8) | data[step->offset + 1];
+        raw = step->shift ? (int16_t)raw : raw;
+        break;
+      case DECODE_LE16:
+        raw = data[step->offset] | (data[step->offset + 1] << 8);
+        raw = step->shift ? (int16_t)raw : raw;
+        break;
+      default:
+        raw = extractRaw(*step->signal, data);
+        break;
+    }
+    int32_t value = raw * step->mul;
+    if (step->div != 1) {
+      value /= step->div;
+    }
+    value += step->add;
+    if (step->target >= CHANNEL_COUNT) {
+      writeIndicator(step->target - CHANNEL_COUNT, value != 0);
+    } else if (step->decimals == 1) {
+      writeChannel(step->target, value, now);
+    } else {
+      writeChannel(step->target, scaleFixed(value, 1, step->decimals), now);
+    }
+  }
+  return true;
+}
+
+// Fill `ids` with the distinct CAN IDs the decoder needs, returns the count
+uint8_t getCANDecoderIds(uint16_t *ids, uint8_t maxIds) {
+  uint8_t count = 0;
+  for (uint16_t slot = 0; slot < CAN_DECODER_ID_SPAN && count < maxIds; slot++) {
+    if (signalCount[slot] > 0) {
+      ids[count++] = activeProtocol->idBase + slot;
+    }
+  }
+  return count;
+}
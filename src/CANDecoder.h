@@ -0,0 +1,49 @@
+#ifndef CAN_DECODER_H
+#define CAN_DECODER_H
+
+#include <stdint.h>
+#include "DisplayConfig.h"
+
+// Signal flags
+#define SIG_BIG_ENDIAN 0x01   // Multi-byte value is MSB first (Haltech)
+#define SIG_SIGNED     0x02   // Sign-extend the raw value
+#define SIG_BIT        0x04   // Single status bit, `length` holds the bit index
+
+// Signal targets: data sources first, indicators after them
+#define SIG_TARGET_INDICATOR(i) (DATA_SOURCE_COUNT + (i))
+
+// Width of the O(1) ID lookup window, starting at the protocol's idBase
+#define CAN_DECODER_ID_SPAN 0xA0
+#define CAN_DECODER_MAX_SIGNALS 64  // Compiled steps for the active protocol
+
+// One decoded field of a CAN frame.
+// Decoded value = raw * mul / div + add, in tenths of the target unit
+// (data sources) or 0/1 (indicators). Pure integer math on the hot path.
+struct CANSignal {
+  uint16_t id;        // CAN identifier
+  uint8_t offset;     // First payload byte
+  uint8_t length;     // Bytes (1-4), or bit index when SIG_BIT is set
+  uint8_t flags;      // SIG_* flags
+  uint8_t target;     // DataSource, or SIG_TARGET_INDICATOR(IndicatorSource)
+  int16_t mul;
+  uint16_t div;
+  int32_t add;
+};
+
+// An ECU broadcast protocol plugin: a signal table plus the base of its ID window
+struct CANProtocol {
+  const char *name;
+  uint16_t idBase;           // Lowest ID, lookup covers idBase .. idBase + CAN_DECODER_ID_SPAN - 1
+  const CANSignal *signals;  // Sorted by ID
+  uint8_t signalCount;
+};
+
+// Function declarations
+void initCANDecoder();
+void selectCANProtocol(uint8_t protocol);
+uint8_t getCANProtocol();
+bool protocolCarriesId(uint8_t protocol, uint32_t id);
+bool decodeCANFrame(uint32_t id, const uint8_t *data, uint8_t length);
+uint8_t getCANDecoderIds(uint16_t *ids, uint8_t maxIds);
+
+#endif // CAN_DECODER_H
@@ -0,0 +1,125 @@
+#include "CANFilterPlanner.h"
+
+// Exhaustive two-way partition search is used up to this many IDs
+#define EXHAUSTIVE_PLAN_MAX_IDS 16
+
+// Smallest code/mask pair covering a group of IDs
+struct FilterGroup {
+  uint16_t code;
+  uint16_t mask;
+  bool empty;
+};
+
+static void addToGroup(FilterGroup &group, uint16_t id) {
+  if (group.empty) {
+    group.code = id;
+    group.mask = 0;
+    group.empty = false;
+  } else {
+    group.mask |= (group.code ^ id) & CAN_STD_ID_MASK;
+    group.code &= ~group.mask;
+  }
+}
+
+static uint16_t groupSize(const FilterGroup &group) {
+  return group.empty ? 0 : (uint16_t)(1u << __builtin_popcount(group.mask));
+}
+
+// Distinct IDs accepted by two filters together
+static uint16_t unionSize(const FilterGroup &a, const FilterGroup &b) {
+  uint16_t total = groupSize(a) + groupSize(b);
+  if (a.empty || b.empty) {
+    return total;
+  }
+  uint16_t fixedInBoth = ~(a.mask | b.mask) & CAN_STD_ID_MASK;
+  if ((a.code & fixedInBoth) == (b.code & fixedInBoth)) {
+    total -= (uint16_t)(1u << __builtin_popcount(a.mask & b.mask));
+  }
+  return total;
+}
+
+static void storePlan(CANFilterPlan &plan, const FilterGroup &a, const FilterGroup &b, uint16_t accepted, uint8_t wanted) {
+  plan.filterCount = b.empty ? 1 : 2;
+  plan.code[0] = a.code;
+  plan.mask[0] = a.mask;
+  plan.code[1] = b.empty ? a.code : b.code;
+  plan.mask[1] = b.empty ? a.mask : b.mask;
+  plan.acceptedIds = accepted;
+  plan.unwantedIds = accepted - wanted;
+}
+
+// Compute the tightest single or dual acceptance filter for the given IDs.
+// The TWAI block offers one 11-bit filter, or two in dual filter mode.
+void planCANFilters(const uint16_t *ids, uint8_t count, CANFilterPlan &plan) {
+  FilterGroup all = {0, 0, true};
+  FilterGroup none = {0, 0, true};
+  for (uint8_t i = 0; i < count; i++) {
+    addToGroup(all, ids[i] & CAN_STD_ID_MASK);
+  }
+  if (count == 0) {
+    // Nothing wanted - accept everything rather than silence the bus
+    all.code = 0;
+    all.mask = CAN_STD_ID_MASK;
+    all.empty = false;
+  }
+  uint16_t best = groupSize(all);
+  storePlan(plan, all, none, best, count);
+  if (count < 2) {
+    return;
+  }
+
+  if (count <= EXHAUSTIVE_PLAN_MAX_IDS) {
+    // ids[0] stays in group A, try every assignment of the rest
+    uint32_t combinations = 1u << (count - 1);
+    for (uint32_t split = 1; split < combinations; split++) {
+      FilterGroup a = {0, 0, true};
+      FilterGroup b = {0, 0, true};
+      addToGroup(a, ids[0] & CAN_STD_ID_MASK);
+      for (uint8_t i = 1; i < count; i++) {
+        addToGroup((split & (1u << (i - 1))) ? b : a, ids[i] & CAN_STD_ID_MASK);
+      }
+      uint16_t accepted = unionSize(a, b);
+      if (accepted < best) {
+        best = accepted;
+        storePlan(plan, a, b, accepted, count);
+      }
+    }
+    return;
+  }
+
+  // Large ID sets: split on each ID bit
+  for (uint8_t bit = 0; bit < 11; bit++) {
+    FilterGroup a = {0, 0, true};
+    FilterGroup b = {0, 0, true};
+    for (uint8_t i = 0; i < count; i++) {
+      uint16_t id = ids[i] & CAN_STD_ID_MASK;
+      addToGroup((id & (1u << bit)) ? b : a, id);
+    }
+    if (a.empty || b.empty) {
+      continue;
+    }
+    uint16_t accepted = unionSize(a, b);
+    if (accepted < best) {
+      best = accepted;
+      storePlan(plan, a, b, accepted, count);
+    }
+  }
+}
+
+// TWAI register layout for standard frames (RTR and data bytes left as don't care):
+//   single filter: ID in bits 31..21
+//   dual filter:   filter 1 ID in bits 31..21, filter 2 ID in bits 15..5
+uint32_t getTWAIAcceptanceCode(const CANFilterPlan &plan) {
+  if (plan.filterCount == 1) {
+    return (uint32_t)plan.code[0] << 21;
+  }
+  return ((uint32_t)plan.code[0] << 21) | ((uint32_t)plan.code[1] << 5);
+}
+
+uint32_t getTWAIAcceptanceMask(const CANFilterPlan &plan) {
+  if (plan.filterCount == 1) {
+    return ((uint32_t)plan.mask[0] << 21) | 0x001FFFFF;
+  }
+  return ((uint32_t)plan.mask[0] << 21) | 0x001F000F |
+         ((uint32_t)plan.mask[1] << 5) | 0x00000010;
+}
@@ -0,0 +1,23 @@
+#ifndef CAN_FILTER_PLANNER_H
+#define CAN_FILTER_PLANNER_H
+
+#include <stdint.h>
+
+#define CAN_STD_ID_MASK 0x7FF
+
+// Hardware acceptance plan for 11-bit IDs.
+// Mask bits set to 1 are "don't care", matching the TWAI convention.
+struct CANFilterPlan {
+  uint8_t filterCount;      // 1 = single filter mode, 2 = dual filter mode
+  uint16_t code[2];         // ID pattern per filter
+  uint16_t mask[2];         // Don't-care bits per filter
+  uint16_t acceptedIds;     // Distinct IDs the hardware lets through
+  uint16_t unwantedIds;     // Accepted IDs the decoder does not need
+};
+
+// Function declarations
+void planCANFilters(const uint16_t *ids, uint8_t count, CANFilterPlan &plan);
+uint32_t getTWAIAcceptanceCode(const CANFilterPlan &plan);
+uint32_t getTWAIAcceptanceMask(const CANFilterPlan &plan);
+
+#endif // CAN_FILTER_PLANNER_H
@@ -1,61 +1,251 @@
 #include "CANHandler.h"
+#include "CANDecoder.h"
+#include "CANFilterPlanner.h"
+#include "CANStats.h"
+#include "CANBaudProbe.h"
+#include "CANProtocols.h"
+#include "Telemetry.h"
 #include "DisplayConfig.h"
 #include "Config.h"
 #include "DataTypes.h"
+#include "Simulator.h"
 #include <esp32_can.h>
+#include "driver/twai.h"
 #include "Arduino.h"
 
+// Frames handed over by the esp32_can RX dispatch, drained in batches by canTask
+static QueueHandle_t canRxQueue = NULL;
+static volatile uint32_t canFramesDropped = 0;
+static uint32_t canFramesProcessed = 0;
+static uint32_t canMaxBatch = 0;
+static uint64_t canDecodeCycles = 0;
+static uint32_t canUnwantedFrames = 0;
+
+// esp32_can hands this config to twai_driver_install() in begin()
+extern twai_filter_config_t twai_filters_cfg;
+
+static void processCANFrame(const CAN_FRAME &can_message);
+
+// RX callback - runs in the CAN driver's dispatch context, so only enqueue here.
+// The TWAI controller has no RX timestamp and esp32_can gives no hook in its ISR, so
+// this is the earliest point to stamp a frame: the jitter stats include the driver's
+// queue and dispatch latency on top of the ECU's own broadcast jitter.
+static void onCANFrame(CAN_FRAME *frame) {
+  frame->timestamp = micros();  // Dispatch time for the inter-arrival stats
+  if (xQueueSend(canRxQueue, frame, 0) != pdTRUE) {
+    canFramesDropped++;
+  }
+}
+
+void getCANIngestStats(CANIngestStats &stats) {
+  twai_status_info_t status;
+  stats.framesProcessed = canFramesProcessed;
+  stats.queueDrops = canFramesDropped;
+  stats.maxBatch = canMaxBatch;
+  stats.queueDepth = canRxQueue ? uxQueueMessagesWaiting(canRxQueue) : 0;
+  stats.unwantedFrames = canUnwantedFrames;
+  stats.cyclesPerFrame = canFramesProcessed ? (uint32_t)(canDecodeCycles / canFramesProcessed) : 0;
+  if (twai_get_status_info(&status) == ESP_OK) {
+    stats.driverMissed = status.rx_missed_count;
+    stats.driverOverruns = status.rx_overrun_count;
+  } else {
+    stats.driverMissed = 0;
+    stats.driverOverruns = 0;
+  }
+}
+
+static bool getTWAITiming(uint32_t bitrate, twai_timing_config_t &timing) {
+  switch (bitrate) {
+    case 1000000: { twai_timing_config_t t = TWAI_TIMING_CONFIG_1MBITS(); timing = t; return true; }
+    case 500000:  { twai_timing_config_t t = TWAI_TIMING_CONFIG_500KBITS(); timing = t; return true; }
+    case 250000:  { twai_timing_config_t t = TWAI_TIMING_CONFIG_250KBITS(); timing = t; return true; }
+    case 125000:  { twai_timing_config_t t = TWAI_TIMING_CONFIG_125KBITS(); timing = t; return true; }
+    default: return false;
+  }
+}
+
+// Install the TWAI driver in listen-only mode: it never ACKs or sends error frames,
+// so a wrong bitrate guess can't disturb the bus
+static bool startListenOnly(uint32_t bitrate) {
+  twai_general_config_t general = TWAI_GENERAL_CONFIG_DEFAULT(GPIO_NUM_16, GPIO_NUM_17, TWAI_MODE_LISTEN_ONLY);
+  twai_timing_config_t timing;
+  twai_filter_config_t filter = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+  if (!getTWAITiming(bitrate, timing)) {
+    return false;
+  }
+  if (twai_driver_install(&general, &timing, &filter) != ESP_OK) {
+    return false;
+  }
+  if (twai_start() != ESP_OK) {
+    twai_driver_uninstall();
+    return false;
+  }
+  return true;
+}
+
+static void stopListenOnly() {
+  twai_stop();
+  twai_driver_uninstall();
+}
+
+// Listen to the bus at one bitrate, feeding each frame and bus error to the probe
+// until it reaches a verdict or the window closes
+static void sampleCANBitrate(uint32_t bitrate, CANBaudSample &sample) {
+  beginCANBaudSample(sample, bitrate, millis());
+  if (!startListenOnly(bitrate)) {
+    return;
+  }
+
+  twai_message_t message;
+  twai_status_info_t status;
+  uint32_t errorsSeen = 0;
+  CANBaudStep step = CAN_BAUD_STEP_LISTEN;
+  while (step == CAN_BAUD_STEP_LISTEN) {
+    bool received = twai_receive(&message, pdMS_TO_TICKS(10)) == ESP_OK;
+    step = stepCANBaudSample(sample, received ? CAN_BAUD_EVENT_FRAME : CAN_BAUD_EVENT_IDLE, millis());
+    if (twai_get_status_info(&status) == ESP_OK) {
+      while (step == CAN_BAUD_STEP_LISTEN && errorsSeen < status.bus_error_count) {
+        errorsSeen++;
+        step = stepCANBaudSample(sample, CAN_BAUD_EVENT_ERROR, millis());
+      }
+    }
+  }
+
+  stopListenOnly();
+}
+
+// Probe candidate bitrates, configured one first, and persist the winner.
+// Falls back to the configured bitrate when the bus is silent or nothing is clean.
+static uint32_t detectCANBitrate(uint32_t configured) {
+  const uint32_t candidates[] = {1000000, 500000, 250000, 125000};
+  const uint8_t candidateCount = sizeof(candidates) / sizeof(candidates[0]);
+  CANBaudSample samples[candidateCount + 1];
+  uint8_t sampled = 0;
+  uint32_t start = millis();
+
+  sampleCANBitrate(configured, samples[sampled]);
+  Serial.printf("[CAN] Probe %u bps: %u valid, %u errors\n", configured, samples[sampled].validFrames, samples[sampled].errorFrames);
+  bool done = isCANBaudSampleConclusive(samples[sampled++]);
+
+  for (uint8_t i = 0; i < candidateCount && !done; i++) {
+    if (candidates[i] == configured) continue;  // Skip already tried speed
+    sampleCANBitrate(candidates[i], samples[sampled]);
+    Serial.printf("[CAN] Probe %u bps: %u valid, %u errors\n", candidates[i], samples[sampled].validFrames, samples[sampled].errorFrames);
+    done = isCANBaudSampleConclusive(samples[sampled++]);
+  }
+
+  int8_t best = selectCANBitrate(samples, sampled);
+  Serial.printf("[CAN] Bitrate probe took %u ms\n", (uint32_t)(millis() - start));
+  if (best < 0) {
+    Serial.printf("[CAN] No clean traffic detected, keeping %u bps\n", configured);
+    return configured;
+  }
+
+  uint32_t detected = samples[best].bitrate;
+  Serial.printf("[CAN] ✓ Detected bus bitrate %u bps\n", detected);
+  if (detected != configured) {
+    setCanSpeed(detected);  // Save working speed
+  }
+  return detected;
+}
+
+// Listen for a few hundred ms and pick the protocol whose IDs show up most.
+// Returns `fallback` on a silent bus or when no known ID was seen.
+static uint8_t sniffCANProtocol(uint32_t bitrate, uint8_t fallback) {
+  uint16_t hits[CAN_PROTOCOL_COUNT] = {0};
+  if (!startListenOnly(bitrate)) {
+    return fallback;
+  }
+
+  uint32_t start = millis();
+  twai_message_t message;
+  while (millis() - start < CAN_PROTOCOL_SNIFF_MS) {
+    if (twai_receive(&message, pdMS_TO_TICKS(10)) != ESP_OK) {
+      continue;
+    }
+    for (uint8_t p = 0; p < CAN_PROTOCOL_COUNT; p++) {
+      if (protocolCarriesId(p, message.identifier)) {
+        hits[p]++;
+      }
+    }
+  }
+  stopListenOnly();
+
+  uint8_t best = fallback;
+  uint16_t bestHits = 0;
+  for (uint8_t p = 0; p < CAN_PROTOCOL_COUNT; p++) {
+    Serial.printf("[CAN] Sniff %s: %u frames\n", canProtocols[p].name, hits[p]);
+    if (hits[p] > bestHits) {
+      best = p;
+      bestHits = hits[p];
+    }
+  }
+  return best;
+}
+
 void setupCAN() {
   Serial.println("[CAN] Starting CAN initialization...");
 
+  // Created first so canTask can always block on it, even if CAN init fails
+  if (canRxQueue == NULL) {
+    canRxQueue = xQueueCreate(CAN_RX_QUEUE_LEN, sizeof(CAN_FRAME));
+  }
+
+  initCANDecoder();
+
   // Set CAN pins - GPIO 17 (RX) and GPIO 16 (TX)
   CAN0.setCANPins(GPIO_NUM_17, GPIO_NUM_16); // RX, TX (fixed order)
   Serial.printf("[CAN] CAN pins set: RX=GPIO17, TX=GPIO16\n");
 
-  uint32_t canSpeed = getCanSpeed();
+  // Find the real bus bitrate before bringing the controller up in normal mode
+  uint32_t canSpeed = detectCANBitrate(getCanSpeed());
+
+  // Pick the ECU protocol, sniffing the bus when set to auto
+  uint8_t protocol = getCanProtocol();
+  if (protocol == CAN_PROTOCOL_AUTO) {
+    protocol = sniffCANProtocol(canSpeed, CAN_PROTOCOL_HALTECH);
+  }
+  selectCANProtocol(protocol);
+  Serial.printf("[CAN] Using %s protocol\n", canProtocols[protocol].name);
+
+  // Program the hardware acceptance filter before the driver is installed
+  uint16_t ids[CAN_DECODER_ID_SPAN];
+  uint8_t idCount = getCANDecoderIds(ids, CAN_DECODER_ID_SPAN);
+  CANFilterPlan filterPlan;
+  planCANFilters(ids, idCount, filterPlan);
+  twai_filters_cfg.acceptance_code = getTWAIAcceptanceCode(filterPlan);
+  twai_filters_cfg.acceptance_mask = getTWAIAcceptanceMask(filterPlan);
+  twai_filters_cfg.single_filter = (filterPlan.filterCount == 1);
+  Serial.printf("[CAN] HW filter: %u filter(s), %u IDs accepted, %u of them unwanted\n",
+                filterPlan.filterCount, filterPlan.acceptedIds, filterPlan.unwantedIds);
+  for (uint8_t i = 0; i < filterPlan.filterCount; i++) {
+    Serial.printf("[CAN]   code=0x%03X mask=0x%03X\n", filterPlan.code[i], filterPlan.mask[i]);
+  }
+
   Serial.printf("[CAN] Attempting to start CAN at %u bps\n", canSpeed);
   
-  // Try to initialize CAN with configured speed
-  bool canInitialized = false;
   if (CAN0.begin(canSpeed)) {
     Serial.printf("[CAN] ✓ CAN initialization SUCCESS at %u bps\n", canSpeed);
-    canInitialized = true;
   } else {
     Serial.printf("[CAN] ✗ CAN initialization FAILED at %u bps\n", canSpeed);
-    
-    // Try common Speeduino speeds
-    uint32_t speedsToTry[] = {1000000, 500000, 250000, 125000};
-    for (int i = 0; i < 4; i++) {
-      if (speedsToTry[i] == canSpeed) continue; // Skip already tried speed
-      Serial.printf("[CAN] Trying %u bps...\n", speedsToTry[i]);
-      if (CAN0.begin(speedsToTry[i])) {
-        Serial.printf("[CAN] ✓ CAN started successfully at %u bps\n", speedsToTry[i]);
-        setCanSpeed(speedsToTry[i]);  // Save working speed
-        canInitialized = true;
-        break;
-      }
-    }
-    
-    if (!canInitialized) {
-      Serial.println("[CAN] ✗ CAN initialization failed at all speeds!");
-      Serial.println("[CAN] Check hardware: CAN transceiver, wiring, termination resistors");
-      return;
-    }
+    Serial.println("[CAN] Check hardware: CAN transceiver, wiring, termination resistors");
+    return;
   }
   
-  // Set up CAN message filters
-  CAN0.watchFor(0x360);  // RPM, MAP, TPS
-  CAN0.watchFor(0x361);  // Fuel Pressure
-  CAN0.watchFor(0x362);  // Ignition Angle (Leading)
-  CAN0.watchFor(0x368);  // AFR 01
-  CAN0.watchFor(0x369);  // Trigger System Error Count
-  CAN0.watchFor(0x370);  // VSS
-  CAN0.watchFor(0x372);  // Voltage
-  CAN0.watchFor(0x3E0);  // CLT, IAT
-  CAN0.watchFor(0x3E4);  // Indicator
+  // The hardware filter does the coarse work; whatever slips through is
+  // rejected by the decoder's ID lookup, so software accepts everything
+  CAN0.watchFor();
+  Serial.print("[CAN] Decoding CAN IDs:");
+  for (uint8_t i = 0; i < idCount; i++) {
+    registerCANStatsId(ids[i]);
+    Serial.printf(" 0x%03X", ids[i]);
+  }
+  Serial.println();
+
+  // Every accepted frame goes through our queue instead of the library's polled buffer
+  CAN0.setGeneralCallback(onCANFrame);
   
   Serial.println("[CAN] CAN message filters configured");
-  Serial.println("[CAN] Watching for CAN IDs: 0x360, 0x361, 0x362, 0x368, 0x369, 0x370, 0x372, 0x3E0, 0x3E4");
 
   isCANMode = true;
   Serial.println("[CAN] CAN setup completed successfully!");
@@ -76,153 +266,94 @@ void setupCAN() {
 }
 
 void canTask(void *pvParameters) {
+  CAN_FRAME frame;
   while (1) {
+#if ENABLE_SIMULATOR
+    // Simulated data replaces the bus from this task, so the channels keep one writer
+    if (getSimulatorMode() != SIMULATOR_MODE_OFF) {
+      xQueueReset(canRxQueue);
+      updateSimulatorData();
+      vTaskDelay(pdMS_TO_TICKS(10));
+      continue;
+    }
+#endif
+    // Sleep until the RX callback queues a frame; the timeout keeps the summary alive on a silent bus.
+    // Returns at once while a capped batch left frames behind.
+    xQueuePeek(canRxQueue, &frame, pdMS_TO_TICKS(100));
     handleCANCommunication();
-    vTaskDelay(1);
   }
 }
 
 void handleCANCommunication() {
-  static uint32_t lastRefresh = millis();
-  static uint32_t messageCount = 0;
   static unsigned long lastDebugPrint = 0;
-  static unsigned long lastHealthCheck = 0;
-  
-  uint32_t elapsed = millis() - lastRefresh;
-  refreshRate = (elapsed > 0) ? (1000 / elapsed) : 0;
-  lastRefresh = millis();
+  static unsigned long lastStatusPoll = 0;
+  static uint32_t lastUnwantedFrames = 0;
   unsigned long currentTime = millis();
   
   isCANMode = true;  // We're in CAN mode when this function is called
   
-  if (CAN0.available()) {
-    messageCount++;
-    CAN_FRAME can_message;
-    if (CAN0.read(can_message)) {
-      // Reduced debug output - only print every 100 messages or for specific debug
-      if (messageCount % 100 == 0) {
-        Serial.printf("[CAN] Msg #%u - ID:0x%03X, Len:%d\n", messageCount, can_message.id, can_message.length);
-      }
-      
-      // Process data based on ID
-      switch (can_message.id) {
-        case 0x360: {
-          rpm = (can_message.data.byte[0] << 8) | can_message.data.byte[1];
-          uint16_t map = (can_message.data.byte[2] << 8) | can_message.data.byte[3];
-          uint16_t tps_raw = (can_message.data.byte[4] << 8) | can_message.data.byte[5];
-          mapData = map / 10.0;
-          tps = tps_raw / 10.0;
-          
-          // Debug important data every 50 messages
-          if (messageCount % 50 == 0) {
-            Serial.printf("[CAN] 0x360: RPM=%u, MAP=%d, TPS=%d\n", rpm, mapData, tps);
-          }
-          break;
-        }
-        case 0x361: {
-          uint16_t fuel_pressure = (can_message.data.byte[0] << 8) | can_message.data.byte[1];
-          // uint16_t oil_pressure = (can_message.data.byte[2] << 8) | can_message.data.byte[3];
-          fp = fuel_pressure / 10 - 101.3;
-          break;
-        }
-        case 0x368: {
-          uint16_t afr_raw = (can_message.data.byte[0] << 8) | can_message.data.byte[1];
-          float lambda = afr_raw / 1000.0;
-          afrConv = lambda * 14.7;
-          
-          // Debug AFR data occasionally
-          if (messageCount % 100 == 0) {
-            Serial.printf("[CAN] 0x368: AFR=%.1f\n", afrConv);
-          }
-          break;
-        }
-        case 0x369: {
-          uint16_t trigger_raw = (can_message.data.byte[0] << 8) | can_message.data.byte[1];
-          triggerError = trigger_raw;
-          break;
-        }
-        case 0x370: {
-          uint16_t vss_raw = (can_message.data.byte[0] << 8) | can_message.data.byte[1];
-          vss = vss_raw / 10.0;
-          break;
-        }
-        case 0x372: {
-          uint16_t voltage = (can_message.data.byte[0] << 8) | can_message.data.byte[1];
-          bat = voltage / 10.0;
-          
-          // Debug voltage data occasionally
-          if (messageCount % 100 == 0) {
-            Serial.printf("[CAN] 0x372: BAT=%.1fV\n", bat);
-          }
-          break;
-        }
-        case 0x3E0: {
-          uint16_t clt_raw = (can_message.data.byte[0] << 8) | can_message.data.byte[1];
-          uint16_t iat_raw = (can_message.data.byte[2] << 8) | can_message.data.byte[3];
-          float clt_k = clt_raw / 10.0;
-          float iat_k = iat_raw / 10.0;
-          clt = clt_k - 273.15;
-          iat = iat_k - 273.15;
-          
-          // Debug temperature data occasionally
-          if (messageCount % 100 == 0) {
-            Serial.printf("[CAN] 0x3E0: CLT=%d°C, IAT=%d°C\n", (int)clt, (int)iat);
-          }
-          break;
-        }
-        case 0x3E4: {
-          // Indicators/Status bits - Haltech CAN protocol format
-          // Based on Haltech CAN Protocol documentation
-          
-          uint8_t byte1 = can_message.data.byte[1];
-          uint8_t byte2 = can_message.data.byte[2]; 
-          uint8_t byte3 = can_message.data.byte[3];
-          uint8_t byte7 = can_message.data.byte[7];
-          
-          // Byte 1 status bits
-          // 1:4 = Decel Cut Active, 1:2 = Brake Pedal Switch, 1:1 = Clutch Switch
-          dfco = (byte1 & 0x10) ? true : false;           // Byte 1, bit 4 - Decel Cut Active
-          
-          // Byte 2 status bits  
-          // 2:7 = Launch Control Active, 2:1 = Torque Reduction Active
-          launch = (byte2 & 0x80) ? true : false;         // Byte 2, bit 7 - Launch Control Active
-          rev = (byte2 & 0x02) ? true : false;            // Byte 2, bit 1 - Torque Reduction Active (REV limiter)
-          
-          // Byte 3 status bits
-          // 3:5 = Air Con Request, 3:4 = Air Con Output, 3:0 = Thermo-fan 1 On
-          airCon = (byte3 & 0x10) ? true : false;         // Byte 3, bit 4 - Air Con Output
-          fan = (byte3 & 0x01) ? true : false;            // Byte 3, bit 0 - Thermo-fan 1 On
-          
-          // Byte 7 status bits
-          // 7:0 = Traction Control Light
-          syncStatus = (byte7 & 0x01) ? true : false;     // Using TC Light as sync indicator
-          
-          break;
-        }
-        case 0x362: {
-          uint16_t adv_raw = (can_message.data.byte[4] << 8) | can_message.data.byte[5];
-          adv = adv_raw / 10.0;
-          break;
-        }
-        default:
-          break;
-      }
-    } else {
-      Serial.println("[CAN] Error reading CAN message.");
-    }
+  // Drain at most one queue's worth per call, so a flood still gets publishes, rate
+  // updates and the summary in between; canTask comes straight back for the rest
+  CAN_FRAME can_message;
+  uint32_t batch = 0;
+  uint32_t batchStart = ESP.getCycleCount();
+  while (batch < CAN_RX_QUEUE_LEN && xQueueReceive(canRxQueue, &can_message, 0) == pdTRUE) {
+    processCANFrame(can_message);
+    batch++;
+  }
+  canDecodeCycles += ESP.getCycleCount() - batchStart;
+  canFramesProcessed += batch;
+  if (batch > 0) {
+    publishTelemetry();
+  }
+
+  // Frame rates roll once per second, controller error state every 100ms
+  updateCANStatsRates(currentTime);
+  refreshRate = getCANFramesPerSec();
+  if (currentTime - lastStatusPoll >= 100) {
+    pollCANBusStatus();
+    lastStatusPoll = currentTime;
+  }
+  if (batch > canMaxBatch) {
+    canMaxBatch = batch;
   }
 
   // Print periodic summary of all CAN data received (every 5 seconds)
   if (currentTime - lastDebugPrint > 5000) {
+    CANIngestStats stats;
+    getCANIngestStats(stats);
     Serial.println("[CAN] === Data Summary ===");
-    Serial.printf("[CAN] RPM: %u, MAP: %d kPa, TPS: %d%%\n", rpm, mapData, tps);
-    Serial.printf("[CAN] CLT: %d°C, IAT: %d°C, BAT: %.1fV\n", (int)clt, (int)iat, bat);
-    Serial.printf("[CAN] AFR: %.1f, FP: %d psi, ADV: %d°\n", afrConv, fp, adv);
-    Serial.printf("[CAN] Indicators: SYNC=%s, FAN=%s, REV=%s, LCH=%s, AC=%s, DFCO=%s\n", 
-                  syncStatus ? "ON" : "OFF", fan ? "ON" : "OFF", rev ? "ON" : "OFF",
-                  launch ? "ON" : "OFF", airCon ? "ON" : "OFF", dfco ? "ON" : "OFF");
-    Serial.printf("[CAN] Messages processed: %u, Refresh rate: %u Hz\n", messageCount, refreshRate);
+    printChannels("CAN");
+    Serial.printf("[CAN] Messages processed: %u, Bus rate: %u frames/s\n", stats.framesProcessed, refreshRate);
+    Serial.printf("[CAN] Drops: queue=%u, driver missed=%u, overruns=%u, max batch=%u\n",
+                  stats.queueDrops, stats.driverMissed, stats.driverOverruns, stats.maxBatch);
+    Serial.printf("[CAN] Unwanted frames past HW filter: %u/s\n",
+                  (stats.unwantedFrames - lastUnwantedFrames) * 1000 / (uint32_t)(currentTime - lastDebugPrint));
+    lastUnwantedFrames = stats.unwantedFrames;
+    Serial.printf("[CAN] Decode cost: %u cycles/frame (~%u frames/s capacity)\n", stats.cyclesPerFrame,
+                  stats.cyclesPerFrame ? ESP.getCpuFreqMHz() * 1000000 / stats.cyclesPerFrame : 0);
     lastDebugPrint = currentTime;
   }
 
+  // A full batch means the bus is outrunning us; give core 0's idle task a tick so
+  // the task watchdog stays fed. The queue absorbs the frames that arrive meanwhile.
+  if (batch == CAN_RX_QUEUE_LEN) {
+    vTaskDelay(1);
+  }
+}
+
+static void processCANFrame(const CAN_FRAME &can_message) {
+  static uint32_t messageCount = 0;
+  messageCount++;
+  recordCANFrame(can_message.id, can_message.timestamp);
+
+  // Reduced debug output - only print every 100 messages or for specific debug
+  if (messageCount % 100 == 0) {
+    Serial.printf("[CAN] Msg #%u - ID:0x%03X, Len:%d\n", messageCount, can_message.id, can_message.length);
+  }
+
+  // Table-driven decode; frames with no known signals passed the HW filter for nothing
+  if (!decodeCANFrame(can_message.id, can_message.data.byte, can_message.length)) {
+    canUnwantedFrames++;
+  }
 }
@@ -1,9 +1,24 @@
 #ifndef CAN_HANDLER_H
 #define CAN_HANDLER_H
 
+#include <stdint.h>
+
+// CAN ingest counters - drops are split by where the frame was lost
+struct CANIngestStats {
+  uint32_t framesProcessed;   // Frames decoded by canTask
+  uint32_t queueDrops;        // Frames lost because our RX queue was full
+  uint32_t driverMissed;      // Frames lost in the TWAI driver queue
+  uint32_t driverOverruns;    // Frames lost to controller FIFO overrun
+  uint32_t maxBatch;          // Largest batch drained in one pass, capped at CAN_RX_QUEUE_LEN
+  uint32_t queueDepth;        // Frames currently waiting in the RX queue
+  uint32_t unwantedFrames;    // Frames that passed the HW filter but carry no decoded signal
+  uint32_t cyclesPerFrame;    // Average CPU cycles spent dequeuing + decoding a frame
+};
+
 // Function declarations
 void setupCAN();
 void handleCANCommunication();
 void canTask(void *pvParameters);
+void getCANIngestStats(CANIngestStats &stats);
 
 #endif // CAN_HANDLER_H
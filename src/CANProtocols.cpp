@@ -0,0 +1,68 @@
+#include "CANProtocols.h"
+
+// Each protocol is a signal table for the generic decoder. Keep tables sorted by ID,
+// all IDs within CAN_DECODER_ID_SPAN of the protocol's idBase.
+
+// Haltech broadcast (big-endian), also sent by Speeduino in Haltech mode
+static const CANSignal haltechSignals[] = {
+  // id     off len flags                      target                              mul  div   add
+  {0x360,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_RPM,                    10,  1,    0},     // RPM, 1 rpm
+  {0x360,   2,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_MAP,                    1,   1,    0},     // MAP, 0.1 kPa
+  {0x360,   4,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_TPS,                    1,   1,    0},     // TPS, 0.1 %
+  {0x361,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_FP,                     1,   1,    -1013}, // Fuel pressure, 0.1 kPa abs
+  {0x362,   4,  2,  SIG_BIG_ENDIAN | SIG_SIGNED, DATA_SOURCE_ADV,                    1,   1,    0},     // Ignition angle (leading), 0.1 deg
+  {0x368,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_AFR,                    147, 1000, 0},     // Lambda 1, 0.001 -> AFR
+  {0x369,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_TRIGGER,                10,  1,    0},     // Trigger error count
+  {0x370,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_VSS,                    1,   1,    0},     // Vehicle speed, 0.1 km/h
+  {0x372,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_VOLTAGE,                1,   1,    0},     // Battery voltage, 0.1 V
+  {0x3E0,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_COOLANT,                1,   1,    -2732}, // CLT, 0.1 K
+  {0x3E0,   2,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_IAT,                    1,   1,    -2732}, // IAT, 0.1 K
+  {0x3E4,   1,  4,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_DFCO), 1, 1,    0},     // 1:4 Decel cut active
+  {0x3E4,   2,  7,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_LCH),  1, 1,    0},     // 2:7 Launch control active
+  {0x3E4,   2,  1,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_REV),  1, 1,    0},     // 2:1 Torque reduction active
+  {0x3E4,   3,  4,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_AC),   1, 1,    0},     // 3:4 Air con output
+  {0x3E4,   3,  0,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_FAN),  1, 1,    0},     // 3:0 Thermo-fan 1 on
+  {0x3E4,   7,  0,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_SYNC), 1, 1,    0},     // 7:0 TC light, used as sync
+};
+
+// rusEFI native dash broadcast (little-endian), default base ID 0x200
+static const CANSignal rusefiSignals[] = {
+  // id     off len flags        target                                mul  div    add
+  {0x200,   4,  0,  SIG_BIT,      SIG_TARGET_INDICATOR(INDICATOR_REV),  1,   1,     0},    // BASE0 4:0 Rev limiter active
+  {0x200,   4,  6,  SIG_BIT,      SIG_TARGET_INDICATOR(INDICATOR_FAN),  1,   1,     0},    // BASE0 4:6 Fan active
+  {0x201,   0,  2,  0,            DATA_SOURCE_RPM,                      10,  1,     0},    // BASE1 RPM, 1 rpm
+  {0x201,   2,  2,  SIG_SIGNED,   DATA_SOURCE_ADV,                      1,   5,     0},    // BASE1 Ignition timing, 0.02 deg
+  {0x201,   6,  1,  0,            DATA_SOURCE_VSS,                      10,  1,     0},    // BASE1 Vehicle speed, 1 km/h
+  {0x202,   2,  2,  SIG_SIGNED,   DATA_SOURCE_TPS,                      1,   10,    0},    // BASE2 TPS1, 0.01 %
+  {0x203,   0,  2,  0,            DATA_SOURCE_MAP,                      1,   3,     0},    // BASE3 MAP, 1/30 kPa
+  {0x203,   2,  1,  0,            DATA_SOURCE_COOLANT,                  10,  1,     -400}, // BASE3 CLT, 1 C offset -40
+  {0x203,   3,  1,  0,            DATA_SOURCE_IAT,                      10,  1,     -400}, // BASE3 IAT, 1 C offset -40
+  {0x204,   4,  2,  0,            DATA_SOURCE_VOLTAGE,                  1,   100,   0},    // BASE4 Battery voltage, 0.001 V
+  {0x207,   0,  2,  0,            DATA_SOURCE_AFR,                      147, 10000, 0},    // BASE7 Lambda 1, 0.0001 -> AFR
+  {0x207,   4,  2,  0,            DATA_SOURCE_FP,                       1,   3,     0},    // BASE7 Fuel pressure (low), 1/30 kPa
+};
+
+// Megasquirt simplified dash broadcast (big-endian), base ID 1520, also sent by Speeduino
+static const CANSignal msDashSignals[] = {
+  // id     off len flags                      target                                 mul  div  add
+  {0x5F0,   6,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_RPM,                       10,  1,   0},    // 1520 RPM, 1 rpm
+  {0x5F1,   0,  2,  SIG_BIG_ENDIAN | SIG_SIGNED, DATA_SOURCE_ADV,                       1,   1,   0},    // 1521 Advance, 0.1 deg
+  {0x5F1,   3,  0,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_SYNC),  1,   1,   0},    // 1521 engine:0 Running
+  {0x5F1,   3,  2,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_ASE),   1,   1,   0},    // 1521 engine:2 After-start enrichment
+  {0x5F1,   3,  3,  SIG_BIT,                     SIG_TARGET_INDICATOR(INDICATOR_WUE),   1,   1,   0},    // 1521 engine:3 Warm-up enrichment
+  {0x5F2,   2,  2,  SIG_BIG_ENDIAN | SIG_SIGNED, DATA_SOURCE_MAP,                       1,   1,   0},    // 1522 MAP, 0.1 kPa
+  {0x5F2,   4,  2,  SIG_BIG_ENDIAN | SIG_SIGNED, DATA_SOURCE_IAT,                       5,   9,   -178}, // 1522 MAT, 0.1 F
+  {0x5F2,   6,  2,  SIG_BIG_ENDIAN | SIG_SIGNED, DATA_SOURCE_COOLANT,                   5,   9,   -178}, // 1522 CLT, 0.1 F
+  {0x5F3,   0,  2,  SIG_BIG_ENDIAN | SIG_SIGNED, DATA_SOURCE_TPS,                       1,   1,   0},    // 1523 TPS, 0.1 %
+  {0x5F3,   2,  2,  SIG_BIG_ENDIAN | SIG_SIGNED, DATA_SOURCE_VOLTAGE,                   1,   1,   0},    // 1523 Battery voltage, 0.1 V
+  {0x60F,   0,  1,  0,                           DATA_SOURCE_AFR,                       1,   1,   0},    // 1551 AFR1, 0.1 AFR
+  {0x61A,   0,  2,  SIG_BIG_ENDIAN,              DATA_SOURCE_VSS,                       36,  10,  0},    // 1562 VSS1, 0.1 m/s
+};
+
+#define SIGNAL_COUNT(table) (sizeof(table) / sizeof(table[0]))
+
+const CANProtocol canProtocols[CAN_PROTOCOL_COUNT] = {
+  {"Haltech", 0x360, haltechSignals, SIGNAL_COUNT(haltechSignals)},
+  {"rusEFI",  0x200, rusefiSignals,  SIGNAL_COUNT(rusefiSignals)},
+  {"MS Dash", 0x5F0, msDashSignals,  SIGNAL_COUNT(msDashSignals)},
+};
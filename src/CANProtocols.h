@@ -0,0 +1,18 @@
+#ifndef CAN_PROTOCOLS_H
+#define CAN_PROTOCOLS_H
+
+#include "CANDecoder.h"
+
+// Available ECU broadcast protocols, index into canProtocols[]
+enum CANProtocolId {
+  CAN_PROTOCOL_HALTECH,
+  CAN_PROTOCOL_RUSEFI,
+  CAN_PROTOCOL_MS_DASH,
+  CAN_PROTOCOL_COUNT
+};
+
+#define CAN_PROTOCOL_AUTO 0xFF   // Sniff the bus at boot and pick a protocol
+
+extern const CANProtocol canProtocols[CAN_PROTOCOL_COUNT];
+
+#endif // CAN_PROTOCOLS_H
@@ -0,0 +1,203 @@
+#include "CANStats.h"
+#include "driver/twai.h"
+#include <atomic>
+
+// Open-addressed ID -> slot table keeps per-frame updates O(1)
+#define CAN_STATS_HASH_SIZE 64   // Power of two, > 2x CAN_STATS_MAX_IDS
+#define CAN_STATS_EMPTY 0xFF
+
+static CANIdStats idStats[CAN_STATS_MAX_IDS];
+static uint8_t idStatsCount = 0;
+static uint8_t idSlots[CAN_STATS_HASH_SIZE];
+static CANBusStats busStats;
+static uint32_t lastRateUpdate = 0;
+static bool wasErrorPassive = false;
+static bool wasBusOff = false;
+
+// Set by the web/serial side, applied by the CAN task so the counters keep one writer
+static std::atomic<bool> statsResetPending(false);
+
+static inline uint8_t hashCANId(uint16_t id) {
+  return (id ^ (id >> 6)) & (CAN_STATS_HASH_SIZE - 1);
+}
+
+static CANIdStats *findCANIdStats(uint16_t id) {
+  uint8_t h = hashCANId(id);
+  for (uint8_t probe = 0; probe < CAN_STATS_HASH_SIZE; probe++) {
+    uint8_t slot = idSlots[h];
+    if (slot == CAN_STATS_EMPTY) {
+      return NULL;
+    }
+    if (idStats[slot].id == id) {
+      return &idStats[slot];
+    }
+    h = (h + 1) & (CAN_STATS_HASH_SIZE - 1);
+  }
+  return NULL;
+}
+
+static void clearIdStats(CANIdStats &s, uint16_t id) {
+  memset(&s, 0, sizeof(s));
+  s.id = id;
+  s.minIntervalUs = UINT32_MAX;
+}
+
+void resetCANStats() {
+  for (uint8_t i = 0; i < idStatsCount; i++) {
+    clearIdStats(idStats[i], idStats[i].id);
+  }
+  memset(&busStats, 0, sizeof(busStats));
+  wasErrorPassive = false;
+  wasBusOff = false;
+}
+
+void requestCANStatsReset() {
+  statsResetPending.store(true);
+  Serial.println("[CAN] Statistics reset");
+}
+
+void registerCANStatsId(uint16_t id) {
+  if (idStatsCount == 0) {
+    memset(idSlots, CAN_STATS_EMPTY, sizeof(idSlots));
+  }
+  if (idStatsCount >= CAN_STATS_MAX_IDS || findCANIdStats(id) != NULL) {
+    return;
+  }
+  uint8_t h = hashCANId(id);
+  while (idSlots[h] != CAN_STATS_EMPTY) {
+    h = (h + 1) & (CAN_STATS_HASH_SIZE - 1);
+  }
+  idSlots[h] = idStatsCount;
+  clearIdStats(idStats[idStatsCount], id);
+  idStatsCount++;
+}
+
+// Ingest path: O(1) update for one received frame
+void recordCANFrame(uint16_t id, uint32_t arrivalUs) {
+  if (idStatsCount == 0) {
+    return;
+  }
+  CANIdStats *s = findCANIdStats(id);
+  if (s == NULL) {
+    return;
+  }
+
+  s->windowFrames++;
+  if (s->frames++ == 0) {
+    s->lastArrivalUs = arrivalUs;
+    return;
+  }
+
+  uint32_t interval = arrivalUs - s->lastArrivalUs;
+  s->lastArrivalUs = arrivalUs;
+  if (interval < s->minIntervalUs) s->minIntervalUs = interval;
+  if (interval > s->maxIntervalUs) s->maxIntervalUs = interval;
+  s->intervalSumUs += interval;
+  s->intervals++;
+
+  // Period EWMA (1/8 weight), seeded with the first interval
+  if (s->periodUs == 0) {
+    s->periodUs = interval;
+  } else {
+    s->periodUs = s->periodUs + (((int32_t)interval - (int32_t)s->periodUs) >> 3);
+  }
+
+  uint32_t deviation = (interval > s->periodUs) ? interval - s->periodUs : s->periodUs - interval;
+  uint8_t bucket = deviation ? 31 - __builtin_clz(deviation) : 0;
+  if (bucket >= CAN_JITTER_BUCKETS) {
+    bucket = CAN_JITTER_BUCKETS - 1;
+  }
+  s->jitterHist[bucket]++;
+}
+
+// Roll the 1 s frame-rate windows. Cheap to call often; works once per second.
+void updateCANStatsRates(uint32_t nowMs) {
+  if (statsResetPending.exchange(false)) {
+    resetCANStats();
+    lastRateUpdate = nowMs;
+    return;
+  }
+  uint32_t elapsed = nowMs - lastRateUpdate;
+  if (elapsed < 1000) {
+    return;
+  }
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < idStatsCount; i++) {
+    idStats[i].framesPerSec = idStats[i].windowFrames * 1000 / elapsed;
+    idStats[i].windowFrames = 0;
+    total += idStats[i].framesPerSec;
+  }
+  busStats.totalFramesPerSec = total;
+  lastRateUpdate = nowMs;
+}
+
+// Sample controller error state and count transitions
+void pollCANBusStatus() {
+  twai_status_info_t status;
+  if (twai_get_status_info(&status) != ESP_OK) {
+    return;
+  }
+  busStats.txErrorCounter = status.tx_error_counter;
+  busStats.rxErrorCounter = status.rx_error_counter;
+  busStats.busErrors = status.bus_error_count;
+
+  bool errorPassive = status.tx_error_counter >= 128 || status.rx_error_counter >= 128;
+  bool busOff = status.state == TWAI_STATE_BUS_OFF;
+  if (errorPassive && !wasErrorPassive) busStats.errorPassiveEvents++;
+  if (busOff && !wasBusOff) busStats.busOffEvents++;
+  wasErrorPassive = errorPassive;
+  wasBusOff = busOff;
+}
+
+uint32_t getCANFramesPerSec() {
+  return busStats.totalFramesPerSec;
+}
+
+void printCANStats() {
+  Serial.println("=== CAN STATS ===");
+  Serial.printf("Total: %u frames/s, bus errors: %u, error-passive: %u, bus-off: %u, TEC/REC: %u/%u\n",
+                busStats.totalFramesPerSec, busStats.busErrors, busStats.errorPassiveEvents,
+                busStats.busOffEvents, busStats.txErrorCounter, busStats.rxErrorCounter);
+  Serial.println("ID     frames/s  min(us)  avg(us)  max(us)  jitter histogram (log2 us, at dispatch)");
+  for (uint8_t i = 0; i < idStatsCount; i++) {
+    const CANIdStats &s = idStats[i];
+    uint32_t avg = s.intervals ? (uint32_t)(s.intervalSumUs / s.intervals) : 0;
+    Serial.printf("0x%03X  %8u %8u %8u %8u  ", s.id, s.framesPerSec,
+                  s.intervals ? s.minIntervalUs : 0, avg, s.maxIntervalUs);
+    for (uint8_t b = 0; b < CAN_JITTER_BUCKETS; b++) {
+      Serial.printf("%u ", s.jitterHist[b]);
+    }
+    Serial.println();
+  }
+  Serial.println("=================");
+}
+
+String getCANStatsJson() {
+  String json = "{";
+  json += "\"framesPerSec\":" + String(busStats.totalFramesPerSec) + ",";
+  json += "\"busErrors\":" + String(busStats.busErrors) + ",";
+  json += "\"errorPassive\":" + String(busStats.errorPassiveEvents) + ",";
+  json += "\"busOff\":" + String(busStats.busOffEvents) + ",";
+  json += "\"tec\":" + String(busStats.txErrorCounter) + ",";
+  json += "\"rec\":" + String(busStats.rxErrorCounter) + ",";
+  json += "\"ids\":[";
+  for (uint8_t i = 0; i < idStatsCount; i++) {
+    const CANIdStats &s = idStats[i];
+    if (i > 0) json += ",";
+    json += "{";
+    json += "\"id\":" + String(s.id) + ",";
+    json += "\"frames\":" + String(s.frames) + ",";
+    json += "\"framesPerSec\":" + String(s.framesPerSec) + ",";
+    json += "\"minUs\":" + String(s.intervals ? s.minIntervalUs : 0) + ",";
+    json += "\"avgUs\":" + String(s.intervals ? (uint32_t)(s.intervalSumUs / s.intervals) : 0) + ",";
+    json += "\"maxUs\":" + String(s.maxIntervalUs) + ",";
+    json += "\"jitter\":[";
+    for (uint8_t b = 0; b < CAN_JITTER_BUCKETS; b++) {
+      if (b > 0) json += ",";
+      json += String(s.jitterHist[b]);
+    }
+    json += "]}";
+  }
+  json += "]}";
+  return json;
+}
@@ -0,0 +1,47 @@
+#ifndef CAN_STATS_H
+#define CAN_STATS_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define CAN_STATS_MAX_IDS 32
+#define CAN_JITTER_BUCKETS 16   // Bucket i counts |interval - period| in [2^i, 2^(i+1)) us
+
+// Per-ID arrival statistics. Arrivals are stamped when the driver dispatches the
+// frame to onCANFrame(), not at RX, so jitter is an upper bound on the bus jitter.
+struct CANIdStats {
+  uint16_t id;
+  uint32_t frames;            // Total frames seen
+  uint32_t framesPerSec;      // Rate over the last completed 1 s window
+  uint32_t windowFrames;      // Frames in the current window
+  uint32_t lastArrivalUs;
+  uint32_t minIntervalUs;
+  uint32_t maxIntervalUs;
+  uint64_t intervalSumUs;
+  uint32_t intervals;
+  uint32_t periodUs;          // Smoothed broadcast period, reference for jitter
+  uint32_t jitterHist[CAN_JITTER_BUCKETS];
+};
+
+// Controller error state counters
+struct CANBusStats {
+  uint32_t errorPassiveEvents; // Transitions into error-passive
+  uint32_t busOffEvents;       // Transitions into bus-off
+  uint32_t busErrors;          // Bus errors reported by the driver
+  uint32_t txErrorCounter;
+  uint32_t rxErrorCounter;
+  uint32_t totalFramesPerSec;
+};
+
+// Function declarations
+void resetCANStats();
+void requestCANStatsReset();
+void registerCANStatsId(uint16_t id);
+void recordCANFrame(uint16_t id, uint32_t arrivalUs);
+void updateCANStatsRates(uint32_t nowMs);
+void pollCANBusStatus();
+uint32_t getCANFramesPerSec();
+void printCANStats();
+String getCANStatsJson();
+
+#endif // CAN_STATS_H
@@ -0,0 +1,159 @@
+#include "ChannelFilter.h"
+#include "Channels.h"
+#include "text_utils.h"
+
+#define EMA_FRACTION_BITS 8   // Sub-LSB precision kept by the EMA accumulator
+
+static_assert(sizeof(ChannelFilterConfig) == sizeof(uint16_t) && alignof(ChannelFilterConfig) == alignof(uint16_t),
+              "Filter config must be one aligned 16-bit word");
+
+// Ingest side only. State is re-primed whenever the configured filter changes,
+// so the web server can edit the config without touching this.
+struct FilterState {
+  uint8_t type;
+  uint8_t param;
+  bool primed;
+  uint8_t medianCount;
+  uint8_t medianHead;
+  int32_t medianWindow[FILTER_MEDIAN_MAX];
+  int64_t accumulator;   // EMA in 1/2^EMA_FRACTION_BITS units, or the deadband output
+};
+
+static FilterState filterStates[CHANNEL_COUNT];
+
+// Panel redraws the renderer skipped because the filtered value held still
+static uint32_t savedRedraws = 0;
+static uint32_t savedRedrawsPerSec = 0;
+static uint32_t savedWindowStart = 0;
+
+bool isValidFilter(uint8_t type, uint8_t param) {
+  switch (type) {
+    case FILTER_NONE: return true;
+    case FILTER_EMA: return param >= 1 && param <= 4;
+    case FILTER_MEDIAN: return param == 3 || param == FILTER_MEDIAN_MAX;
+    case FILTER_DEADBAND: return param >= 1;
+    default: return false;
+  }
+}
+
+// Type and param as one word, so a reader never pairs a new type with the old param
+// (e.g. MEDIAN with a deadband of 0, or EMA with a shift of 32)
+ChannelFilterConfig loadFilterConfig(uint8_t channel) {
+  uint16_t word = __atomic_load_n(reinterpret_cast<const uint16_t *>(&currentDisplayConfig.filters[channel]), __ATOMIC_RELAXED);
+  ChannelFilterConfig config;
+  memcpy(&config, &word, sizeof(config));
+  return config;
+}
+
+void storeFilterConfig(uint8_t channel, uint8_t type, uint8_t param) {
+  ChannelFilterConfig config = {type, param};
+  uint16_t word;
+  memcpy(&word, &config, sizeof(word));
+  __atomic_store_n(reinterpret_cast<uint16_t *>(&currentDisplayConfig.filters[channel]), word, __ATOMIC_RELAXED);
+}
+
+static int32_t medianOf(const FilterState &state) {
+  int32_t sorted[FILTER_MEDIAN_MAX];
+  uint8_t n = state.medianCount;
+  for (uint8_t i = 0; i < n; i++) {
+    int32_t v = state.medianWindow[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > v) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = v;
+  }
+  return sorted[n / 2];
+}
+
+// Filter one sample in the channel's fixed-point units. O(1), no allocation.
+int32_t applyChannelFilter(uint8_t channel, int32_t value) {
+  if (channel >= CHANNEL_COUNT) {
+    return value;
+  }
+  ChannelFilterConfig config = loadFilterConfig(channel);
+  if (!isValidFilter(config.type, config.param)) {
+    config.type = FILTER_NONE;
+    config.param = 0;
+  }
+  FilterState &state = filterStates[channel];
+  if (!state.primed || state.type != config.type || state.param != config.param) {
+    state.type = config.type;
+    state.param = config.param;
+    state.primed = true;
+    state.medianCount = 0;
+    state.medianHead = 0;
+    state.accumulator = (config.type == FILTER_EMA) ? (int64_t)value << EMA_FRACTION_BITS : value;
+  }
+
+  switch (state.type) {
+    case FILTER_EMA:
+      // 64-bit so large derived values don't overflow once shifted up
+      state.accumulator += (((int64_t)value << EMA_FRACTION_BITS) - state.accumulator) >> state.param;
+      return (int32_t)((state.accumulator + (1 << (EMA_FRACTION_BITS - 1))) >> EMA_FRACTION_BITS);
+
+    case FILTER_MEDIAN:
+      state.medianWindow[state.medianHead] = value;
+      state.medianHead = (state.medianHead + 1) % state.param;
+      if (state.medianCount < state.param) state.medianCount++;
+      return medianOf(state);
+
+    case FILTER_DEADBAND:
+      if (llabs((int64_t)value - state.accumulator) > state.param) {
+        state.accumulator = value;
+      }
+      return (int32_t)state.accumulator;
+
+    default:
+      return value;
+  }
+}
+
+// Render side: a panel whose raw value changed but filtered value didn't
+void countSavedRedraw() {
+  savedRedraws++;
+}
+
+uint32_t getSavedRedrawsPerSec() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - savedWindowStart;
+  if (elapsed >= 1000) {
+    savedRedrawsPerSec = savedRedraws * 1000 / elapsed;
+    savedRedraws = 0;
+    savedWindowStart = now;
+  }
+  return savedRedrawsPerSec;
+}
+
+static const char *filterTypeName(uint8_t type) {
+  switch (type) {
+    case FILTER_EMA: return "ema";
+    case FILTER_MEDIAN: return "median";
+    case FILTER_DEADBAND: return "deadband";
+    default: return "none";
+  }
+}
+
+// Deadband is reported in display units, the other params as-is
+String getFiltersJson() {
+  char buf[22];
+  String json = "{";
+  json += "\"savedRedrawsPerSec\":" + String(getSavedRedrawsPerSec()) + ",";
+  json += "\"channels\":[";
+  for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+    ChannelFilterConfig config = loadFilterConfig(i);
+    if (i > 0) json += ",";
+    json += "{\"dataSource\":" + String(i) + ",";
+    json += "\"name\":\"" + String(channelInfo[i].name) + "\",";
+    json += "\"type\":\"" + String(filterTypeName(config.type)) + "\",";
+    if (config.type == FILTER_DEADBAND) {
+      formatValue(buf, config.param, channelInfo[i].decimals);
+      json += "\"param\":" + String(buf) + "}";
+    } else {
+      json += "\"param\":" + String(config.param) + "}";
+    }
+  }
+  json += "]}";
+  return json;
+}
@@ -0,0 +1,32 @@
+#ifndef CHANNEL_FILTER_H
+#define CHANNEL_FILTER_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "DisplayConfig.h"
+
+// Ingest-side smoothing, configured per channel in DisplayConfiguration::filters.
+// `param` meaning per type:
+//   FILTER_EMA       1-4, weight of a new sample is 1/2^param
+//   FILTER_MEDIAN    window of 3 or 5 samples
+//   FILTER_DEADBAND  change (fixed-point units) the output ignores
+enum FilterType : uint8_t {
+  FILTER_NONE,
+  FILTER_EMA,
+  FILTER_MEDIAN,
+  FILTER_DEADBAND,
+  FILTER_TYPE_COUNT
+};
+
+#define FILTER_MEDIAN_MAX 5
+
+// Function declarations
+bool isValidFilter(uint8_t type, uint8_t param);
+ChannelFilterConfig loadFilterConfig(uint8_t channel);
+void storeFilterConfig(uint8_t channel, uint8_t type, uint8_t param);
+int32_t applyChannelFilter(uint8_t channel, int32_t value);
+void countSavedRedraw();
+uint32_t getSavedRedrawsPerSec();
+String getFiltersJson();
+
+#endif // CHANNEL_FILTER_H
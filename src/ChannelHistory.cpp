@@ -0,0 +1,220 @@
+#include "ChannelHistory.h"
+#include "Channels.h"
+#include <atomic>
+
+// Summary being built for the interval that is still open
+struct HistoryAccumulator {
+  uint32_t interval;    // Absolute interval number (nowMs / period)
+  int32_t min;
+  int32_t max;
+  int64_t sum;
+  uint32_t count;
+};
+
+// Fixed-size rings for one channel. Written only by the ingest side.
+struct ChannelHistory {
+  int32_t latest[HISTORY_LATEST_SLOTS];  // Decimated: one value per HISTORY_LATEST_PERIOD_MS
+  HistorySummary seconds[HISTORY_SECOND_SLOTS];
+  HistorySummary tenSeconds[HISTORY_TEN_SECOND_SLOTS];
+  uint32_t latestSlot;          // Absolute slot number of the newest latest-tier entry
+  uint16_t latestHead;          // Ring index of the newest latest-tier entry
+  uint16_t secondHead;          // Ring index the next 1 s summary goes to
+  uint16_t tenSecondHead;
+  uint16_t secondCount;         // Valid entries, saturates at the ring size
+  uint16_t tenSecondCount;
+  uint16_t latestCount;
+  HistoryAccumulator second;
+  HistoryAccumulator tenSecond;
+  bool started;
+};
+
+static ChannelHistory histories[CHANNEL_COUNT];
+
+// Per-channel seqlock so readers on other tasks never copy a half-written ring.
+// Odd while the ingest task (the only writer, via writeChannel()) is mid-update.
+static std::atomic<uint32_t> historySequence[CHANNEL_COUNT];
+
+static_assert(sizeof(histories) <= HISTORY_BUDGET_BYTES, "Channel history exceeds HISTORY_BUDGET_BYTES");
+
+static const HistorySummary emptySummary = {INT32_MAX, INT32_MIN, 0};
+
+static void resetAccumulator(HistoryAccumulator &acc, uint32_t interval) {
+  acc.interval = interval;
+  acc.min = INT32_MAX;
+  acc.max = INT32_MIN;
+  acc.sum = 0;
+  acc.count = 0;
+}
+
+static void addToAccumulator(HistoryAccumulator &acc, int32_t value, uint32_t weight) {
+  if (value < acc.min) acc.min = value;
+  if (value > acc.max) acc.max = value;
+  acc.sum += (int64_t)value * weight;
+  acc.count += weight;
+}
+
+static HistorySummary summarize(const HistoryAccumulator &acc) {
+  if (acc.count == 0) {
+    return emptySummary;
+  }
+  HistorySummary s = {acc.min, acc.max, (int32_t)(acc.sum / acc.count)};
+  return s;
+}
+
+// Push a summary into a ring, then `gaps` empty ones for intervals with no samples
+static void pushSummary(HistorySummary *ring, uint16_t size, uint16_t &head, uint16_t &count,
+                        const HistorySummary &s, uint32_t gaps) {
+  ring[head] = s;
+  head = (head + 1) % size;
+  if (count < size) count++;
+  if (gaps > size) gaps = size;  // Bounded work however long the channel was silent
+  while (gaps--) {
+    ring[head] = emptySummary;
+    head = (head + 1) % size;
+    if (count < size) count++;
+  }
+}
+
+static void startHistory(ChannelHistory &h, uint32_t nowMs) {
+  for (uint16_t i = 0; i < HISTORY_LATEST_SLOTS; i++) {
+    h.latest[i] = HISTORY_NO_DATA;
+  }
+  h.latestSlot = nowMs / HISTORY_LATEST_PERIOD_MS;
+  h.latestHead = 0;
+  h.latestCount = 1;
+  h.secondHead = h.tenSecondHead = 0;
+  h.secondCount = h.tenSecondCount = 0;
+  resetAccumulator(h.second, nowMs / 1000);
+  resetAccumulator(h.tenSecond, nowMs / 10000);
+  h.started = true;
+}
+
+// Ingest path: O(1), allocation-free. Called for every channel write.
+void recordHistorySample(uint8_t channel, int32_t value, uint32_t nowMs) {
+  if (channel >= CHANNEL_COUNT) {
+    return;
+  }
+  ChannelHistory &h = histories[channel];
+  historySequence[channel].fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (!h.started) {
+    startHistory(h, nowMs);
+  }
+
+  // Latest tier: newest value wins within a slot (earlier ones in it are dropped),
+  // skipped slots are marked empty
+  uint32_t slot = nowMs / HISTORY_LATEST_PERIOD_MS;
+  uint32_t advance = slot - h.latestSlot;
+  if (advance > HISTORY_LATEST_SLOTS) advance = HISTORY_LATEST_SLOTS;
+  while (advance--) {
+    h.latestHead = (h.latestHead + 1) % HISTORY_LATEST_SLOTS;
+    h.latest[h.latestHead] = HISTORY_NO_DATA;
+    if (h.latestCount < HISTORY_LATEST_SLOTS) h.latestCount++;
+  }
+  h.latestSlot = slot;
+  h.latest[h.latestHead] = value;
+
+  // 1 s tier; a closed second is folded into the 10 s accumulator
+  uint32_t second = nowMs / 1000;
+  if (second != h.second.interval) {
+    HistorySummary closed = summarize(h.second);
+    pushSummary(h.seconds, HISTORY_SECOND_SLOTS, h.secondHead, h.secondCount,
+                closed, second - h.second.interval - 1);
+    if (h.second.count > 0) {
+      addToAccumulator(h.tenSecond, closed.min, 0);
+      addToAccumulator(h.tenSecond, closed.max, 0);
+      h.tenSecond.sum += h.second.sum;
+      h.tenSecond.count += h.second.count;
+    }
+    resetAccumulator(h.second, second);
+
+    uint32_t tenSecond = nowMs / 10000;
+    if (tenSecond != h.tenSecond.interval) {
+      pushSummary(h.tenSeconds, HISTORY_TEN_SECOND_SLOTS, h.tenSecondHead, h.tenSecondCount,
+                  summarize(h.tenSecond), tenSecond - h.tenSecond.interval - 1);
+      resetAccumulator(h.tenSecond, tenSecond);
+    }
+  }
+  addToAccumulator(h.second, value, 1);
+
+  historySequence[channel].fetch_add(1, std::memory_order_release);
+}
+
+uint16_t getHistoryCapacity(uint8_t tier) {
+  switch (tier) {
+    case HISTORY_TIER_LATEST: return HISTORY_LATEST_SLOTS;
+    case HISTORY_TIER_SECOND: return HISTORY_SECOND_SLOTS;
+    case HISTORY_TIER_TEN_SECOND: return HISTORY_TEN_SECOND_SLOTS;
+    default: return 0;
+  }
+}
+
+uint32_t getHistoryPeriodMs(uint8_t tier) {
+  switch (tier) {
+    case HISTORY_TIER_LATEST: return HISTORY_LATEST_PERIOD_MS;
+    case HISTORY_TIER_SECOND: return 1000;
+    case HISTORY_TIER_TEN_SECOND: return 10000;
+    default: return 0;
+  }
+}
+
+// Copy a tier newest-first into `out` (latest-tier values come back with min = max = avg).
+// Lock-free: retries if the ingest task appended meanwhile.
+uint16_t readHistory(uint8_t channel, uint8_t tier, HistorySummary *out, uint16_t maxCount) {
+  if (channel >= CHANNEL_COUNT || tier >= HISTORY_TIER_COUNT) {
+    return 0;
+  }
+  const ChannelHistory &h = histories[channel];
+  uint32_t before, after;
+  uint16_t n;
+  do {
+    before = historySequence[channel].load(std::memory_order_acquire);
+    n = 0;
+    if (h.started) {
+      if (tier == HISTORY_TIER_LATEST) {
+        for (uint16_t i = 0; i < h.latestCount && n < maxCount; i++) {
+          int32_t v = h.latest[(h.latestHead + HISTORY_LATEST_SLOTS - i) % HISTORY_LATEST_SLOTS];
+          out[n++] = (v == HISTORY_NO_DATA) ? emptySummary : HistorySummary{v, v, v};
+        }
+      } else {
+        const HistorySummary *ring = (tier == HISTORY_TIER_SECOND) ? h.seconds : h.tenSeconds;
+        uint16_t size = getHistoryCapacity(tier);
+        uint16_t head = (tier == HISTORY_TIER_SECOND) ? h.secondHead : h.tenSecondHead;
+        uint16_t count = (tier == HISTORY_TIER_SECOND) ? h.secondCount : h.tenSecondCount;
+        for (uint16_t i = 1; i <= count && n < maxCount; i++) {
+          out[n++] = ring[(head + size - i) % size];
+        }
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = historySequence[channel].load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+  return n;
+}
+
+// Newest-first export of one tier, values in the channel's fixed-point unit
+String getHistoryJson(uint8_t channel, uint8_t tier) {
+  static HistorySummary buffer[HISTORY_LATEST_SLOTS > HISTORY_SECOND_SLOTS ?
+                               (HISTORY_LATEST_SLOTS > HISTORY_TEN_SECOND_SLOTS ? HISTORY_LATEST_SLOTS : HISTORY_TEN_SECOND_SLOTS) :
+                               (HISTORY_SECOND_SLOTS > HISTORY_TEN_SECOND_SLOTS ? HISTORY_SECOND_SLOTS : HISTORY_TEN_SECOND_SLOTS)];
+  uint16_t n = readHistory(channel, tier, buffer, getHistoryCapacity(tier));
+
+  String json = "{";
+  json += "\"channel\":\"" + String(channel < CHANNEL_COUNT ? channelInfo[channel].name : "") + "\",";
+  json += "\"decimals\":" + String(channel < CHANNEL_COUNT ? channelInfo[channel].decimals : 0) + ",";
+  json += "\"periodMs\":" + String(getHistoryPeriodMs(tier)) + ",";
+  json += "\"samples\":[";
+  for (uint16_t i = 0; i < n; i++) {
+    if (i > 0) json += ",";
+    if (buffer[i].min > buffer[i].max) {
+      json += "null";
+    } else if (tier == HISTORY_TIER_LATEST) {
+      json += String(buffer[i].avg);
+    } else {
+      json += "[" + String(buffer[i].min) + "," + String(buffer[i].max) + "," + String(buffer[i].avg) + "]";
+    }
+  }
+  json += "]}";
+  return json;
+}
@@ -0,0 +1,32 @@
+#ifndef CHANNEL_HISTORY_H
+#define CHANNEL_HISTORY_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Config.h"
+
+#define HISTORY_LATEST_SLOTS (HISTORY_LATEST_SECONDS * 1000 / HISTORY_LATEST_PERIOD_MS)
+#define HISTORY_NO_DATA INT32_MIN   // Latest-tier slot with no sample in it
+
+enum HistoryTier {
+  HISTORY_TIER_LATEST,     // Newest value in each HISTORY_LATEST_PERIOD_MS slot, not every sample
+  HISTORY_TIER_SECOND,     // 1 s min/max/avg
+  HISTORY_TIER_TEN_SECOND, // 10 s min/max/avg
+  HISTORY_TIER_COUNT
+};
+
+// Downsampled interval; min > max means no sample arrived in it
+struct HistorySummary {
+  int32_t min;
+  int32_t max;
+  int32_t avg;
+};
+
+// Function declarations
+void recordHistorySample(uint8_t channel, int32_t value, uint32_t nowMs);
+uint16_t readHistory(uint8_t channel, uint8_t tier, HistorySummary *out, uint16_t maxCount);
+uint16_t getHistoryCapacity(uint8_t tier);
+uint32_t getHistoryPeriodMs(uint8_t tier);
+String getHistoryJson(uint8_t channel, uint8_t tier);
+
+#endif // CHANNEL_HISTORY_H
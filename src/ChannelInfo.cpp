@@ -0,0 +1,37 @@
+#include "Channels.h"
+
+// Channel descriptions and fixed-point scaling, kept free of Arduino and ingest
+// dependencies so host tests build against the same table as the firmware
+
+// Indexed by DataSource
+ChannelInfo channelInfo[CHANNEL_COUNT] = {
+  {"IAT",     "C",   1},
+  {"Coolant", "C",   1},
+  {"AFR",     "",    1},
+  {"ADV",     "deg", 1},
+  {"Trigger", "",    0},
+  {"TPS",     "%",   1},
+  {"Voltage", "V",   1},
+  {"MAP",     "kPa", 1},
+  {"RPM",     "rpm", 0},
+  {"FP",      "psi", 1},
+  {"VSS",     "km/h", 1},
+  {"D1",      "",    0},
+  {"D2",      "",    0},
+  {"D3",      "",    0},
+  {"D4",      "",    0},
+};
+
+static const int32_t pow10Table[] = {1, 10, 100, 1000, 10000};
+
+// Change the number of decimals of a fixed-point value, rounding half away from zero
+int32_t scaleFixed(int32_t value, uint8_t fromDecimals, uint8_t toDecimals) {
+  if (fromDecimals == toDecimals) {
+    return value;
+  }
+  if (toDecimals > fromDecimals) {
+    return value * pow10Table[toDecimals - fromDecimals];
+  }
+  int32_t div = pow10Table[fromDecimals - toDecimals];
+  return (value >= 0) ? (value + div / 2) / div : (value - div / 2) / div;
+}
@@ -0,0 +1,89 @@
+#include "Channels.h"
+#include "Config.h"
+#include "ChannelHistory.h"
+#include "AlarmRules.h"
+#include "SessionPeaks.h"
+#include "ChannelFilter.h"
+#include "text_utils.h"
+#include "Arduino.h"
+
+// Written only by the ingest task (CAN or Serial, which also steps the simulator),
+// published by publishTelemetry()
+static ChannelTable ingestChannels;
+
+#define PERIOD_FRACTION_BITS 8  // Sub-ms precision kept by the period EWMA
+
+// Learned period in 1/2^PERIOD_FRACTION_BITS ms; periodMs[] is this rounded
+static uint32_t periodAccumulator[CHANNEL_COUNT];
+
+// Store a decoded value and learn how often the channel updates.
+// Peaks see the raw sample; the shown value, alarms and history see the filtered one.
+void writeChannel(uint8_t channel, int32_t rawValue, uint32_t nowMs) {
+  if (channel >= CHANNEL_COUNT) {
+    return;
+  }
+  recordPeak(channel, rawValue, nowMs);
+  ingestChannels.raw[channel] = rawValue;
+  int32_t value = applyChannelFilter(channel, rawValue);
+  if (ingestChannels.value[channel] != value) {
+    ingestChannels.value[channel] = value;
+    ingestChannels.changes[channel]++;
+  }
+  ingestChannels.severity[channel] = updateAlarm(channel, value, nowMs);
+  recordHistorySample(channel, value, nowMs);
+
+  uint32_t last = ingestChannels.updatedMs[channel];
+  ingestChannels.updatedMs[channel] = nowMs ? nowMs : 1;
+  if (last == 0) {
+    return;
+  }
+
+  uint32_t interval = nowMs - last;
+  uint16_t period = ingestChannels.periodMs[channel];
+  if (period == 0) {
+    if (interval > 0xFFFF) interval = 0xFFFF;
+    periodAccumulator[channel] = interval << PERIOD_FRACTION_BITS;
+    ingestChannels.periodMs[channel] = interval;
+  } else if (interval <= (uint32_t)period * CHANNEL_STALE_PERIODS) {
+    // EWMA with 1/8 weight on a fractional accumulator, so truncation doesn't drag the
+    // period down; gaps long enough to count as stale are not learned
+    int32_t error = (int32_t)(interval << PERIOD_FRACTION_BITS) - (int32_t)periodAccumulator[channel];
+    periodAccumulator[channel] += error >> 3;
+    uint32_t rounded = (periodAccumulator[channel] + (1 << (PERIOD_FRACTION_BITS - 1))) >> PERIOD_FRACTION_BITS;
+    ingestChannels.periodMs[channel] = rounded > 0xFFFF ? 0xFFFF : (rounded ? rounded : 1);
+  }
+}
+
+void writeIndicator(uint8_t indicator, bool on) {
+  if (indicator >= INDICATOR_COUNT) {
+    return;
+  }
+  if (on) {
+    ingestChannels.indicators |= (1UL << indicator);
+  } else {
+    ingestChannels.indicators &= ~(1UL << indicator);
+  }
+}
+
+// Ingest-side reads, for logic that derives one value from another before publishing
+int32_t readChannel(uint8_t channel) {
+  return channel < CHANNEL_COUNT ? ingestChannels.value[channel] : 0;
+}
+
+bool readIndicator(uint8_t indicator) {
+  return indicator < INDICATOR_COUNT && (ingestChannels.indicators & (1UL << indicator));
+}
+
+const ChannelTable &getIngestChannels() {
+  return ingestChannels;
+}
+
+void printChannels(const char *tag) {
+  char buf[22] = {0};
+  Serial.printf("[%s]", tag);
+  for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+    formatValue(buf, ingestChannels.value[i], channelInfo[i].decimals);
+    Serial.printf(" %s: %s%s", channelInfo[i].name, buf, channelInfo[i].unit);
+  }
+  Serial.printf(" | indicators: 0x%02X\n", ingestChannels.indicators);
+}
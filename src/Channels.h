@@ -0,0 +1,40 @@
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <stdint.h>
+#include "DisplayConfig.h"
+
+#define CHANNEL_COUNT DATA_SOURCE_COUNT
+
+// Struct-of-arrays channel store indexed by DataSource.
+// Values are fixed-point: value / 10^decimals in the channel's unit.
+struct ChannelTable {
+  int32_t value[CHANNEL_COUNT];        // After the channel's filter
+  int32_t raw[CHANNEL_COUNT];          // As decoded, before filtering
+  uint32_t updatedMs[CHANNEL_COUNT];   // millis() of the last write, 0 = never seen
+  uint16_t periodMs[CHANNEL_COUNT];    // Learned update period, 0 = not learned yet
+  uint16_t changes[CHANNEL_COUNT];     // Bumped every time the value changes
+  uint8_t severity[CHANNEL_COUNT];     // AlarmSeverity, evaluated as each sample is written
+  uint32_t indicators;                 // Bit per IndicatorSource
+};
+
+// Static description of a channel
+struct ChannelInfo {
+  const char *name;
+  const char *unit;
+  uint8_t decimals;     // Fixed-point scale of value[]
+};
+
+// Derived channel entries are filled in from the display config when compiled
+extern ChannelInfo channelInfo[CHANNEL_COUNT];
+
+// Function declarations
+void writeChannel(uint8_t channel, int32_t value, uint32_t nowMs);
+void writeIndicator(uint8_t indicator, bool on);
+int32_t readChannel(uint8_t channel);
+bool readIndicator(uint8_t indicator);
+const ChannelTable &getIngestChannels();
+int32_t scaleFixed(int32_t value, uint8_t fromDecimals, uint8_t toDecimals);
+void printChannels(const char *tag);
+
+#endif // CHANNELS_H
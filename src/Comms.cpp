@@ -1,54 +1,281 @@
 #include "Arduino.h"
 #include "Comms.h"
+#include <atomic>
 
-bool requestData(uint16_t timeout)
+// Incremental parser for the three response formats:
+//   'n'        -> 'n', 0x32, length, then length data bytes
+//   'r'        -> 'r', 0x30, then the requested number of data bytes
+//   framed 'r' -> length (BE16), RC_OK flag + data, CRC32 of flag + data (BE32)
+enum ResponseState {
+  STATE_IDLE,
+  STATE_COMMAND,
+  STATE_TYPE,
+  STATE_LENGTH,
+  STATE_FRAME_LENGTH_HI,
+  STATE_FRAME_LENGTH_LO,
+  STATE_FRAME_FLAG,
+  STATE_DATA,
+  STATE_FRAME_CRC
+};
+
+#define SERIAL_RC_OK 0x00
+
+// Responses are assembled in the back buffer; the getters only ever see the
+// front one, which is replaced by a pointer swap once a whole poll has arrived
+static uint8_t rxBuffers[2][DATA_LEN];
+static uint8_t *backBuffer = rxBuffers[0];
+static std::atomic<const uint8_t *> frontBuffer(rxBuffers[1]);
+
+static ResponseState responseState = STATE_IDLE;
+static uint32_t requestStart = 0;
+static uint32_t requestStartUs = 0;
+static uint32_t lastRoundTripUs = 0;
+static uint8_t expectedCommand = 'n';
+static uint8_t expectedType = 0x32;
+static uint16_t dataLen = 0;
+static uint16_t dataIndex = 0;
+
+static bool framed = false;
+static uint16_t frameLength = 0;
+static uint32_t frameCrc = 0;
+static uint32_t receivedCrc = 0;
+static uint8_t crcBytes = 0;
+static uint32_t crcFailures = 0;
+
+// CRC-32 (IEEE 802.3, as used by the Speeduino/TunerStudio framing), 4 bits at a time
+static const uint32_t crc32Nibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len)
+{
+  while (len--) {
+    crc = crc32Nibble[(crc ^ *data) & 0x0F] ^ (crc >> 4);
+    crc = crc32Nibble[(crc ^ (*data >> 4)) & 0x0F] ^ (crc >> 4);
+    data++;
+  }
+  return crc;
+}
+
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+  return ~crc32Update(0xFFFFFFFF, data, len);
+}
+
+static void startRequest(uint8_t command, uint8_t type, uint16_t offset, uint16_t length)
+{
+  expectedCommand = command;
+  expectedType = type;
+  dataIndex = offset;
+  dataLen = offset + length;
+  requestStart = millis();
+  requestStartUs = micros();
+  responseState = (framed && command == 'r') ? STATE_FRAME_LENGTH_HI : STATE_COMMAND;
+}
+
+static SerialResponseStatus failResponse()
+{
+  responseState = STATE_IDLE;
+  return RESPONSE_ERROR;
+}
+
+static SerialResponseStatus completeResponse()
+{
+  responseState = STATE_IDLE;
+  lastRoundTripUs = micros() - requestStartUs;
+  return RESPONSE_COMPLETE;
+}
+
+void setSerialFraming(bool enabled)
 {
-  Serial1.setTimeout(timeout);
+  framed = enabled;
+  responseState = STATE_IDLE;
+}
 
-  while (Serial1.available()) Serial1.read(); // Flush buffer
+bool isSerialFramed()
+{
+  return framed;
+}
+
+uint32_t getSerialCrcFailures()
+{
+  return crcFailures;
+}
+
+// Send the request and return at once; the response is assembled by pollDataResponse()
+void sendDataRequest()
+{
+  while (Serial1.available()) Serial1.read(); // Flush leftovers from a dropped response
 
   Serial1.write('n');
+  startRequest('n', 0x32, 0, 0);
+}
+
+// Read `length` realtime bytes starting at `offset` into the same place 'n' would put them
+bool sendRangeRequest(uint16_t offset, uint16_t length)
+{
+  if (length == 0 || offset + length > DATA_LEN) {
+    return false;
+  }
+
+  while (Serial1.available()) Serial1.read();
 
-  uint32_t start = millis();
-  uint32_t end = start;
-  while (Serial1.available() < 3 && (end - start) < timeout)
-  {
-    end = millis();
-  }
-
-  if (end - start < timeout && Serial1.available() >= 3)
-  {
-    Serial1.read(); // 'n'
-    Serial1.read(); // 0x32
-    uint8_t dataLen = Serial1.read();
-    if (dataLen <= DATA_LEN) {
-      Serial1.readBytes(buffer, dataLen);
-      return true; 
-    } else {
-      Serial.println("Data overflow: Invalid data length");
-      Serial.println(dataLen);
+  uint8_t request[7] = {
+    'r',
+    0x00,                   // CAN ID, always 0 for the ECU itself
+    0x30,                   // Realtime output channels
+    lowByte(offset), highByte(offset),
+    lowByte(length), highByte(length)
+  };
+  if (framed) {
+    uint32_t crc = crc32(request, sizeof(request));
+    uint8_t header[2] = {0, sizeof(request)};
+    uint8_t trailer[4] = {(uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc};
+    Serial1.write(header, sizeof(header));
+    Serial1.write(request, sizeof(request));
+    Serial1.write(trailer, sizeof(trailer));
+  } else {
+    Serial1.write(request, sizeof(request));
+  }
+  startRequest('r', 0x30, offset, length);
+  return true;
+}
+
+// Consume whatever has arrived so far. Never waits for more bytes.
+SerialResponseStatus pollDataResponse(uint16_t timeout)
+{
+  if (responseState == STATE_IDLE) {
+    return RESPONSE_ERROR;
+  }
+
+  while (Serial1.available() > 0) {
+    if (responseState == STATE_DATA) {
+      // Bulk copy the data bytes that are already in the UART buffer
+      size_t count = min((size_t)Serial1.available(), (size_t)(dataLen - dataIndex));
+      size_t read = Serial1.readBytes(backBuffer + dataIndex, count);
+      if (framed) {
+        frameCrc = crc32Update(frameCrc, backBuffer + dataIndex, read);
+      }
+      dataIndex += read;
+      if (dataIndex >= dataLen) {
+        if (framed) {
+          responseState = STATE_FRAME_CRC;
+          receivedCrc = 0;
+          crcBytes = 0;
+          continue;
+        }
+        return completeResponse();
+      }
+      continue;
+    }
+
+    uint8_t b = Serial1.read();
+    switch (responseState) {
+      case STATE_COMMAND:
+        if (b != expectedCommand) {
+          return failResponse();
+        }
+        responseState = STATE_TYPE;
+        break;
+      case STATE_TYPE:
+        if (b != expectedType) {
+          return failResponse();
+        }
+        // 'r' has no length byte, the length is the one we asked for
+        responseState = (expectedCommand == 'n') ? STATE_LENGTH : STATE_DATA;
+        break;
+      case STATE_LENGTH:
+        dataLen = b;
+        if (dataLen > DATA_LEN) {
+          Serial.println("Data overflow: Invalid data length");
+          Serial.println(dataLen);
+          return failResponse();
+        }
+        if (dataLen == 0) {
+          return completeResponse();
+        }
+        responseState = STATE_DATA;
+        break;
+      case STATE_FRAME_LENGTH_HI:
+        frameLength = (uint16_t)b << 8;
+        responseState = STATE_FRAME_LENGTH_LO;
+        break;
+      case STATE_FRAME_LENGTH_LO:
+        frameLength |= b;
+        // Flag byte plus exactly the bytes we asked for
+        if (frameLength != 1 + (dataLen - dataIndex)) {
+          return failResponse();
+        }
+        responseState = STATE_FRAME_FLAG;
+        break;
+      case STATE_FRAME_FLAG:
+        if (b != SERIAL_RC_OK) {
+          return failResponse();
+        }
+        frameCrc = crc32Update(0xFFFFFFFF, &b, 1);
+        responseState = STATE_DATA;
+        break;
+      case STATE_FRAME_CRC:
+        receivedCrc = (receivedCrc << 8) | b;
+        if (++crcBytes == 4) {
+          if (receivedCrc != ~frameCrc) {
+            crcFailures++;
+            return failResponse();
+          }
+          return completeResponse();
+        }
+        break;
+      default:
+        break;
     }
   }
-  return false;
 
+  if (millis() - requestStart >= timeout) {
+    responseState = STATE_IDLE;
+    return RESPONSE_TIMEOUT;
+  }
+  return RESPONSE_PENDING;
+}
+
+// Time left before the in-flight request times out, for blocking until more bytes arrive
+uint32_t getResponseWaitMs(uint16_t timeout)
+{
+  uint32_t elapsed = millis() - requestStart;
+  return (elapsed < timeout) ? (timeout - elapsed) : 0;
+}
+
+// Request-to-last-byte time of the most recent completed response
+uint32_t getLastRoundTripUs()
+{
+  return lastRoundTripUs;
+}
+
+// Make the back buffer visible to the getters. Call only after every response
+// of a poll completed and passed its checks; nothing is copied.
+void publishDataFrame()
+{
+  const uint8_t *previous = frontBuffer.exchange(backBuffer, std::memory_order_acq_rel);
+  backBuffer = const_cast<uint8_t *>(previous);
 }
 
 bool getBit(uint16_t address, uint8_t bit) {
   if (address < DATA_LEN) {
-    return bitRead(buffer[address], bit);
+    return bitRead(frontBuffer.load(std::memory_order_acquire)[address], bit);
   }
   return false;
 }
 uint8_t getByte(uint16_t address) {
   if (address < DATA_LEN) {
-    return buffer[address];
+    return frontBuffer.load(std::memory_order_acquire)[address];
   }
   return 0;
 }
 
 uint16_t getWord(uint16_t address) {
   if (address < DATA_LEN - 1) {
-    return makeWord(buffer[address + 1], buffer[address]);
+    const uint8_t *frame = frontBuffer.load(std::memory_order_acquire);
+    return makeWord(frame[address + 1], frame[address]);
   }
   return 0;
-}
\ No newline at end of file
+}
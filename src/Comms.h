@@ -4,11 +4,26 @@
 #include "Arduino.h"
 #define DATA_LEN 300
 
-static uint8_t buffer[DATA_LEN];
-bool requestData(uint16_t timeout = 20);
+// Result of feeding the bytes received so far into the response parser
+enum SerialResponseStatus {
+  RESPONSE_PENDING,   // Request in flight, more bytes expected
+  RESPONSE_COMPLETE,  // Full response is in the back buffer
+  RESPONSE_TIMEOUT,   // No complete response within the timeout
+  RESPONSE_ERROR      // Bad header, length or CRC, response dropped
+};
+
+void setSerialFraming(bool enabled);
+bool isSerialFramed();
+uint32_t getSerialCrcFailures();
+void sendDataRequest();
+bool sendRangeRequest(uint16_t offset, uint16_t length);
+SerialResponseStatus pollDataResponse(uint16_t timeout = 30);
+uint32_t getResponseWaitMs(uint16_t timeout = 30);
+uint32_t getLastRoundTripUs();
+void publishDataFrame();
 
 bool getBit(uint16_t address, uint8_t bit);
 uint8_t getByte(uint16_t address);
 uint16_t getWord(uint16_t address);
 
-#endif //COMMS_H
\ No newline at end of file
+#endif //COMMS_H
@@ -0,0 +1,254 @@
+#include "Compositor.h"
+#include "Config.h"
+
+extern TFT_eSPI display;
+
+struct CompositorWidget {
+  int16_t x, y, w, h;
+  CompositorRenderFn render;
+  uint8_t id;
+};
+
+static CompositorWidget widgets[COMPOSITOR_MAX_WIDGETS];
+static uint8_t widgetCount = 0;
+
+// One bit per tile column, one word per tile row
+static uint16_t dirtyTiles[COMPOSITOR_ROWS];
+
+// The exact rects behind the dirty tiles, so windows can be trimmed to them
+struct DirtyRect {
+  int16_t x0, y0, x1, y1;   // x1/y1 exclusive
+};
+static DirtyRect dirtyRects[COMPOSITOR_MAX_DIRTY_RECTS];
+static uint8_t dirtyRectCount = 0;
+static bool dirtyRectsOverflow = false;
+static uint32_t pendingNaiveBytes = 0;
+
+// Two scratch windows when DMA is available: one is rasterized while the other is
+// still streaming out over SPI. Without DMA only the first is used.
+static TFT_eSprite scratch[2] = {TFT_eSprite(&display), TFT_eSprite(&display)};
+static bool dmaEnabled = false;
+static uint8_t nextScratch = 0;
+static CompositorStats stats;
+
+static_assert(COMPOSITOR_COLS <= 16, "dirtyTiles holds 16 columns per row");
+
+static bool createScratch(TFT_eSprite &sprite, uint32_t &allocations) {
+  allocations++;
+  sprite.setColorDepth(16);
+  sprite.setAttribute(PSRAM_ENABLE, false);   // DMA can't read PSRAM
+  return sprite.createSprite(COMPOSITOR_SCRATCH_W, COMPOSITOR_SCRATCH_H) != nullptr;
+}
+
+// Allocate the scratch windows once, with the rest of the layout
+bool initCompositor(uint32_t &allocations) {
+  if (scratch[0].created()) {
+    return true;
+  }
+  if (!createScratch(scratch[0], allocations)) {
+    return false;
+  }
+#if ENABLE_DMA_PUSH
+  if (createScratch(scratch[1], allocations)) {
+    dmaEnabled = display.initDMA();
+    if (!dmaEnabled) {
+      scratch[1].deleteSprite();
+    }
+  }
+  Serial.printf("[DISPLAY] Compositor push: %s\n", dmaEnabled ? "DMA ping-pong" : "blocking");
+#endif
+  return true;
+}
+
+void clearCompositorWidgets() {
+  widgetCount = 0;
+  memset(dirtyTiles, 0, sizeof(dirtyTiles));
+  dirtyRectCount = 0;
+  dirtyRectsOverflow = false;
+  pendingNaiveBytes = 0;
+}
+
+int8_t addCompositorWidget(int16_t x, int16_t y, int16_t w, int16_t h, CompositorRenderFn render, uint8_t id) {
+  if (widgetCount >= COMPOSITOR_MAX_WIDGETS || w <= 0 || h <= 0) {
+    return -1;
+  }
+  widgets[widgetCount] = {x, y, w, h, render, id};
+  return widgetCount++;
+}
+
+void markRegionDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  int16_t c0 = max(0, x / COMPOSITOR_TILE_W);
+  int16_t c1 = min(COMPOSITOR_COLS - 1, (x + w - 1) / COMPOSITOR_TILE_W);
+  int16_t r0 = max(0, y / COMPOSITOR_TILE_H);
+  int16_t r1 = min(COMPOSITOR_ROWS - 1, (y + h - 1) / COMPOSITOR_TILE_H);
+  if (c0 > c1 || r0 > r1) {
+    return;
+  }
+  uint16_t mask = ((1U << (c1 - c0 + 1)) - 1) << c0;
+  for (int16_t r = r0; r <= r1; r++) {
+    dirtyTiles[r] |= mask;
+  }
+  pendingNaiveBytes += (uint32_t)w * h * 2;
+  if (dirtyRectCount < COMPOSITOR_MAX_DIRTY_RECTS) {
+    dirtyRects[dirtyRectCount++] = {x, y, (int16_t)(x + w), (int16_t)(y + h)};
+  } else {
+    dirtyRectsOverflow = true;   // Fall back to whole tiles this frame
+  }
+}
+
+void markWidgetDirty(int8_t widget) {
+  if (widget < 0 || widget >= widgetCount) {
+    return;
+  }
+  const CompositorWidget &wd = widgets[widget];
+  markRegionDirty(wd.x, wd.y, wd.w, wd.h);
+}
+
+// Trim a tile window to the dirty rects inside it; false if none reach into it
+static bool trimWindow(int16_t &x, int16_t &y, int16_t &w, int16_t &h) {
+  if (x + w > COMPOSITOR_SCREEN_W) w = COMPOSITOR_SCREEN_W - x;
+  if (y + h > COMPOSITOR_SCREEN_H) h = COMPOSITOR_SCREEN_H - y;
+  if (dirtyRectsOverflow) {
+    return true;
+  }
+  int16_t x0 = x + w, y0 = y + h, x1 = x, y1 = y;
+  for (uint8_t i = 0; i < dirtyRectCount; i++) {
+    const DirtyRect &d = dirtyRects[i];
+    if (d.x0 >= x + w || d.x1 <= x || d.y0 >= y + h || d.y1 <= y) {
+      continue;
+    }
+    x0 = min(x0, max(d.x0, x));
+    y0 = min(y0, max(d.y0, y));
+    x1 = max(x1, min(d.x1, (int16_t)(x + w)));
+    y1 = max(y1, min(d.y1, (int16_t)(y + h)));
+  }
+  if (x1 <= x0 || y1 <= y0) {
+    return false;
+  }
+  x = x0; y = y0; w = x1 - x0; h = y1 - y0;
+  return true;
+}
+
+// Draw every widget that overlaps the window into the scratch sprite
+static void rasterWindow(TFT_eSprite &target, int16_t x, int16_t y, int16_t w, int16_t h) {
+  target.fillRect(0, 0, w, h, TFT_BLACK);
+  for (uint8_t i = 0; i < widgetCount; i++) {
+    const CompositorWidget &wd = widgets[i];
+    if (wd.x < x + w && wd.x + wd.w > x && wd.y < y + h && wd.y + wd.h > y) {
+      wd.render(target, x, y, wd.id);
+    }
+  }
+}
+
+// Start the window streaming out of `target` and return without waiting for it.
+// Rows are packed in place first: pushImageDMA wants w x h contiguous pixels,
+// the sprite has a stride of COMPOSITOR_SCRATCH_W.
+static void pushWindowDMA(TFT_eSprite &target, int16_t x, int16_t y, int16_t w, int16_t h, uint32_t &waitUs) {
+  uint16_t *pixels = (uint16_t *)target.getPointer();
+  if (w < COMPOSITOR_SCRATCH_W) {
+    for (int16_t row = 1; row < h; row++) {
+      memmove(pixels + row * w, pixels + row * COMPOSITOR_SCRATCH_W, w * sizeof(uint16_t));
+    }
+  }
+  uint32_t start = micros();
+  display.dmaWait();   // Previous window, in the other buffer
+  waitUs += micros() - start;
+  display.pushImageDMA(x, y, w, h, pixels);
+}
+
+// Greedy cover of the dirty tiles: take the longest run in a row, grow it down
+// while the rows below have the same run dirty, bounded by the scratch size.
+// With DMA the next window is rasterized while the previous one is on the wire,
+// so the frame costs about max(raster, transfer) instead of their sum.
+void compositeDirtyTiles() {
+  if (!scratch[0].created()) {
+    return;
+  }
+  const int16_t maxCols = COMPOSITOR_SCRATCH_W / COMPOSITOR_TILE_W;
+  const int16_t maxRows = COMPOSITOR_SCRATCH_H / COMPOSITOR_TILE_H;
+  uint32_t frameStart = micros();
+  uint32_t bytes = 0;
+  uint32_t windows = 0;
+  uint32_t rasterUs = 0;
+  uint32_t waitUs = 0;
+  bool swapBytes = display.getSwapBytes();
+
+  for (int16_t r = 0; r < COMPOSITOR_ROWS; r++) {
+    while (dirtyTiles[r]) {
+      int16_t c0 = __builtin_ctz(dirtyTiles[r]);
+      int16_t c1 = c0;
+      while (c1 + 1 < COMPOSITOR_COLS && (dirtyTiles[r] & (1U << (c1 + 1))) && c1 - c0 + 1 < maxCols) {
+        c1++;
+      }
+      uint16_t mask = ((1U << (c1 - c0 + 1)) - 1) << c0;
+      int16_t r1 = r;
+      while (r1 + 1 < COMPOSITOR_ROWS && (dirtyTiles[r1 + 1] & mask) == mask && r1 - r + 1 < maxRows) {
+        r1++;
+      }
+      for (int16_t rr = r; rr <= r1; rr++) {
+        dirtyTiles[rr] &= ~mask;
+      }
+      
+      int16_t x = c0 * COMPOSITOR_TILE_W;
+      int16_t y = r * COMPOSITOR_TILE_H;
+      int16_t w = (c1 - c0 + 1) * COMPOSITOR_TILE_W;
+      int16_t h = (r1 - r + 1) * COMPOSITOR_TILE_H;
+      if (!trimWindow(x, y, w, h)) {
+        continue;
+      }
+      
+      if (windows == 0 && dmaEnabled) {
+        display.startWrite();
+        display.setSwapBytes(false);   // Sprite pixels are already in panel byte order
+      }
+      TFT_eSprite &target = scratch[dmaEnabled ? nextScratch : 0];
+      uint32_t start = micros();
+      rasterWindow(target, x, y, w, h);
+      rasterUs += micros() - start;
+      
+      if (dmaEnabled) {
+        pushWindowDMA(target, x, y, w, h, waitUs);
+        nextScratch ^= 1;
+      } else {
+        start = micros();
+        target.pushSprite(x, y, 0, 0, w, h);
+        waitUs += micros() - start;
+      }
+      bytes += (uint32_t)w * h * 2;
+      windows++;
+    }
+  }
+
+  if (windows > 0) {
+    if (dmaEnabled) {
+      uint32_t start = micros();
+      display.dmaWait();
+      waitUs += micros() - start;
+      display.endWrite();
+      display.setSwapBytes(swapBytes);
+    }
+    stats.lastFrameBytes = bytes;
+    stats.lastFrameWindows = windows;
+    stats.lastFrameNaiveBytes = pendingNaiveBytes;
+    stats.lastFrameUs = micros() - frameStart;
+    stats.lastRasterUs = rasterUs;
+    stats.lastTransferWaitUs = waitUs;
+    stats.frames++;
+    stats.totalBytes += bytes;
+    stats.totalNaiveBytes += pendingNaiveBytes;
+  }
+  pendingNaiveBytes = 0;
+  dirtyRectCount = 0;
+  dirtyRectsOverflow = false;
+}
+
+bool isCompositorDMA() {
+  return dmaEnabled;
+}
+
+const CompositorStats &getCompositorStats() {
+  return stats;
+}
@@ -0,0 +1,47 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdint.h>
+#include <TFT_eSPI.h>
+
+// Screen is split into tiles; widgets mark the tiles they cover dirty and each
+// frame the dirty tiles are merged into windows, rendered once from every
+// widget that intersects them, and pushed.
+#define COMPOSITOR_SCREEN_W 320
+#define COMPOSITOR_SCREEN_H 170
+#define COMPOSITOR_TILE_W 32
+#define COMPOSITOR_TILE_H 10
+#define COMPOSITOR_COLS (COMPOSITOR_SCREEN_W / COMPOSITOR_TILE_W)
+#define COMPOSITOR_ROWS ((COMPOSITOR_SCREEN_H + COMPOSITOR_TILE_H - 1) / COMPOSITOR_TILE_H)
+#define COMPOSITOR_SCRATCH_W 128   // Largest window pushed at once: 4 x 5 tiles, 12.8 KB
+#define COMPOSITOR_SCRATCH_H 50
+#define COMPOSITOR_MAX_WIDGETS 24
+#define COMPOSITOR_MAX_DIRTY_RECTS 32
+
+// Draw the widget into `target`, whose top-left is at screen (originX, originY).
+// Background must be left black: layers are composited with black as transparent.
+typedef void (*CompositorRenderFn)(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id);
+
+struct CompositorStats {
+  uint32_t lastFrameBytes;      // Pushed over SPI in the last frame that pushed anything
+  uint32_t lastFrameWindows;
+  uint32_t lastFrameNaiveBytes; // What pushing every dirty widget whole would have cost
+  uint32_t lastFrameUs;         // Raster plus push, wall clock
+  uint32_t lastRasterUs;        // Drawing widgets into the scratch windows
+  uint32_t lastTransferWaitUs;  // Blocked on SPI; with DMA only what raster didn't hide
+  uint32_t frames;
+  uint32_t totalBytes;
+  uint32_t totalNaiveBytes;
+};
+
+// Function declarations
+bool initCompositor(uint32_t &allocations);
+void clearCompositorWidgets();
+int8_t addCompositorWidget(int16_t x, int16_t y, int16_t w, int16_t h, CompositorRenderFn render, uint8_t id);
+void markWidgetDirty(int8_t widget);
+void markRegionDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+void compositeDirtyTiles();
+const CompositorStats &getCompositorStats();
+bool isCompositorDMA();
+
+#endif // COMPOSITOR_H
@@ -20,12 +20,50 @@ extern const char *password;
 #define BACKLIGHT_RESOLUTION 8
 #define BACKLIGHT_BRIGHTNESS 100 // 0-255 (0 = off, 255 = max brightness)
 
+// Serial ECU polling
+#define SERIAL_RESPONSE_TIMEOUT_MS 30  // Upper bound on the adaptive response timeout
+#define SERIAL_RESPONSE_MIN_TIMEOUT_MS 5
+#define SERIAL_BACKOFF_BASE_MS 10      // First delay once polls start failing in a row
+#define SERIAL_BACKOFF_MAX_MS 500
+#define SERIAL_PROBE_TIMEOUT_MS 50     // Wait per baud rate when probing for CRC framing
+#define SERIAL_RANGE_FAILURE_LIMIT 10  // Failed 'r' polls before falling back to 'n'
+
 // Communication modes
 #define COMM_CAN 0
 #define COMM_SERIAL 1
 
+// CAN ingest
+#define CAN_RX_QUEUE_LEN 256  // Frames buffered between the RX callback and canTask
+#define CAN_PROTOCOL_SNIFF_MS 300  // Listen time for ECU protocol auto-detection
+
+// Data freshness - a channel is stale after this many learned periods without an update
+#define CHANNEL_STALE_PERIODS 4
+#define CHANNEL_STALE_MIN_MS 500  // Lower bound so fast channels don't flicker on a single late frame
+#define STALE_VALUE_COLOR TFT_DARKGREY
+
+// Channel history rings (static memory, checked against the budget at compile time)
+#define HISTORY_LATEST_PERIOD_MS 100  // Latest tier keeps only the newest sample per slot
+#define HISTORY_LATEST_SECONDS 10
+#define HISTORY_SECOND_SLOTS 60       // 1 s min/max/avg tier: last minute
+#define HISTORY_TEN_SECOND_SLOTS 60   // 10 s min/max/avg tier: last 10 minutes
+#define HISTORY_BUDGET_BYTES 32768
+
+// Session peaks
+#define PEAK_RECALL_MS 5000           // How long the dash shows peaks after a recall
+
+// Display push
+#define ENABLE_DMA_PUSH 1  // Stream compositor windows with DMA, rasterizing the next meanwhile
+
+// Render task (core 1)
+#define RENDER_TARGET_FPS 30
+#define RENDER_LOW_PRIORITY_PCT 75    // Past this share of the frame budget, indicators wait a frame
+#define RENDER_MAX_DEFER_FRAMES 5     // ...but never more than this many frames in a row
+#define RENDER_FRAME_SAMPLES 128      // Frame times kept for percentiles
+#define RENDER_TASK_STACK 8192
+#define GLYPH_ATLAS_COLOR_SLOTS 3     // Value colors kept pre-rendered, ~9.5 KB each
+
 // Other constants
-#define EEPROM_SIZE 512
+#define EEPROM_SIZE 1024  // Display config at address 10, fit checked by a static_assert in DisplayConfig.cpp
 
 // Simulator configuration
 #define ENABLE_SIMULATOR 1  // Set to 0 to disable simulator completely
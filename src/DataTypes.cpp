@@ -1,18 +1,7 @@
 #include "DataTypes.h"
 #include <WebServer.h>
 
-// Temperature variables
-uint8_t iat = 0, clt = 0;
-uint8_t refreshRate = 0;
-unsigned int rpm = 0, lastRpm = 0, vss = 0;
-int mapData = 0, tps = 0, adv = 0, fp = 0, triggerError = 0;
-float bat = 0.0, afrConv = 0.0;
-bool syncStatus = false, fan = false, ase = false, wue = false, rev = false, launch = false, airCon = false, dfco = false;
-
-// Last values for comparison
-int lastIat = -1, lastClt = -1, lastTps = -1, lastAdv = -1, lastMapData = -1, lastFp = -1, lastTriggerError = -1;
-float lastBat = -1, lastAfrConv = -1;
-unsigned int lastRefreshRate = 0;
+uint16_t refreshRate = 0;
 
 // System variables
 bool first_run = true;
@@ -37,7 +26,7 @@ bool clientConnected = true;
 bool debugMode = false;
 float cpuUsage = 0.0;
 float fps = 0.0;
-uint32_t frameCount = 0;
+volatile uint32_t frameCount = 0;
 uint32_t lastFpsUpdate = 0;
 uint32_t lastCpuMeasure = 0;
 uint32_t loopStartTime = 0;
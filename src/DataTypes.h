@@ -3,18 +3,8 @@
 
 #include <stdint.h>
 
-// Global variables for ECU data
-extern uint8_t iat, clt;
-extern uint8_t refreshRate;
-extern unsigned int rpm, lastRpm, vss;
-extern int mapData, tps, adv, fp, triggerError;
-extern float bat, afrConv;
-extern bool syncStatus, fan, ase, wue, rev, launch, airCon, dfco;
-
-// Last values for comparison
-extern int lastIat, lastClt, lastTps, lastAdv, lastMapData, lastFp, lastTriggerError;
-extern float lastBat, lastAfrConv;
-extern unsigned int lastRefreshRate;
+// ECU data lives in the channel registry (Channels.h), read through Telemetry.h
+extern uint16_t refreshRate;
 
 // System variables
 extern bool first_run;
@@ -40,7 +30,7 @@ extern bool clientConnected;
 extern bool debugMode;
 extern float cpuUsage;
 extern float fps;
-extern uint32_t frameCount;
+extern volatile uint32_t frameCount;   // Frames drawn since boot, written only by the render task
 extern uint32_t lastFpsUpdate;
 extern uint32_t lastCpuMeasure;
 extern uint32_t loopStartTime;
@@ -0,0 +1,402 @@
+#include "DerivedChannels.h"
+#include "Channels.h"
+#include <math.h>
+#include <ctype.h>
+
+enum DerivedOp : uint8_t {
+  OP_END,
+  OP_CONST,     // + constant index
+  OP_CHANNEL,   // + DataSource
+  OP_ADD,
+  OP_SUB,
+  OP_MUL,
+  OP_DIV,
+  OP_NEG,
+  OP_MIN,
+  OP_MAX,
+  OP_ABS
+};
+
+struct DerivedProgram {
+  uint8_t code[DERIVED_CODE_LEN];
+  float constants[DERIVED_MAX_CONSTANTS];
+  uint32_t inputMask;     // Bit per DataSource the expression reads
+  const char *name;       // channelInfo name to apply with the program, NULL keeps the current one
+  uint8_t decimals;       // channelInfo decimals the program's results are scaled to
+  bool valid;
+};
+
+// Compiled by the web/setup side, picked up by the ingest side on its next evaluation
+static DerivedProgram pendingPrograms[DERIVED_CHANNEL_COUNT];
+static volatile bool programsPending = false;
+static portMUX_TYPE programMux = portMUX_INITIALIZER_UNLOCKED;
+static const char *compileErrors[DERIVED_CHANNEL_COUNT];
+
+// Ingest side only
+static DerivedProgram activePrograms[DERIVED_CHANNEL_COUNT];
+static bool resultValid[DERIVED_CHANNEL_COUNT];
+static bool rerunPending[DERIVED_CHANNEL_COUNT];  // New program not yet run on real inputs
+static uint16_t lastChanges[DATA_SOURCE_DERIVED_1];
+static uint32_t lastUpdated[DATA_SOURCE_DERIVED_1];
+
+// Cost accounting
+static uint32_t evaluationCount = 0;   // Programs run
+static uint32_t skippedCount = 0;      // Inputs refreshed but unchanged, program not run
+static uint32_t evaluationPasses = 0;  // Publishes that ran at least one program
+static uint32_t lastPassUs = 0;
+static uint32_t maxPassUs = 0;
+static uint32_t totalPassUs = 0;
+
+static const float fixedScale[] = {1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f};
+
+// Names accepted besides channelInfo[].name, matching the web UI labels
+static const struct {
+  const char *name;
+  uint8_t source;
+} channelAliases[] = {
+  {"CLT", DATA_SOURCE_COOLANT},
+  {"BAT", DATA_SOURCE_VOLTAGE},
+};
+
+// ---- Compiler: recursive descent straight to stack bytecode ----
+
+struct Compiler {
+  const char *p;
+  DerivedProgram *program;
+  uint8_t length;
+  uint8_t constantCount;
+  uint8_t depth;
+  const char *error;
+};
+
+static void skipSpaces(Compiler &c) {
+  while (*c.p == ' ') c.p++;
+}
+
+static bool fail(Compiler &c, const char *error) {
+  if (!c.error) c.error = error;
+  return false;
+}
+
+// Append an instruction; `stackEffect` tracks the evaluator's worst-case depth
+static bool emit(Compiler &c, uint8_t op, int8_t stackEffect) {
+  if (c.length >= DERIVED_CODE_LEN - 1) {  // Keep room for OP_END
+    return fail(c, "Expression too long");
+  }
+  c.program->code[c.length++] = op;
+  c.depth += stackEffect;
+  if (c.depth > DERIVED_STACK_DEPTH) {
+    return fail(c, "Expression nested too deep");
+  }
+  return true;
+}
+
+static bool emitOperand(Compiler &c, uint8_t op, uint8_t operand) {
+  return emit(c, op, 1) && emit(c, operand, 0);
+}
+
+static bool parseExpression(Compiler &c);
+
+static int findChannel(const char *name, size_t len) {
+  for (uint8_t i = 0; i < DATA_SOURCE_DERIVED_1; i++) {
+    if (strlen(channelInfo[i].name) == len && strncasecmp(channelInfo[i].name, name, len) == 0) {
+      return i;
+    }
+  }
+  for (uint8_t i = 0; i < sizeof(channelAliases) / sizeof(channelAliases[0]); i++) {
+    if (strlen(channelAliases[i].name) == len && strncasecmp(channelAliases[i].name, name, len) == 0) {
+      return channelAliases[i].source;
+    }
+  }
+  return -1;
+}
+
+static bool expect(Compiler &c, char ch, const char *error) {
+  skipSpaces(c);
+  if (*c.p != ch) {
+    return fail(c, error);
+  }
+  c.p++;
+  return true;
+}
+
+static bool parsePrimary(Compiler &c) {
+  skipSpaces(c);
+  if (isdigit((unsigned char)*c.p) || *c.p == '.') {
+    char *end;
+    float value = strtof(c.p, &end);
+    if (end == c.p) {
+      return fail(c, "Bad number");
+    }
+    c.p = end;
+    if (c.constantCount >= DERIVED_MAX_CONSTANTS) {
+      return fail(c, "Too many constants");
+    }
+    c.program->constants[c.constantCount] = value;
+    return emitOperand(c, OP_CONST, c.constantCount++);
+  }
+  if (isalpha((unsigned char)*c.p)) {
+    const char *start = c.p;
+    while (isalnum((unsigned char)*c.p) || *c.p == '_') c.p++;
+    size_t len = c.p - start;
+    skipSpaces(c);
+    if (*c.p == '(') {
+      c.p++;
+      uint8_t op;
+      bool binary = true;
+      if (len == 3 && strncasecmp(start, "min", 3) == 0) op = OP_MIN;
+      else if (len == 3 && strncasecmp(start, "max", 3) == 0) op = OP_MAX;
+      else if (len == 3 && strncasecmp(start, "abs", 3) == 0) { op = OP_ABS; binary = false; }
+      else return fail(c, "Unknown function");
+      if (!parseExpression(c)) return false;
+      if (binary && !(expect(c, ',', "Expected ','") && parseExpression(c))) return false;
+      if (!expect(c, ')', "Expected ')'")) return false;
+      return emit(c, op, binary ? -1 : 0);
+    }
+    int channel = findChannel(start, len);
+    if (channel < 0) {
+      return fail(c, "Unknown channel");
+    }
+    c.program->inputMask |= (1UL << channel);
+    return emitOperand(c, OP_CHANNEL, channel);
+  }
+  if (*c.p == '(') {
+    c.p++;
+    return parseExpression(c) && expect(c, ')', "Expected ')'");
+  }
+  return fail(c, *c.p ? "Unexpected character" : "Unexpected end");
+}
+
+static bool parseUnary(Compiler &c) {
+  skipSpaces(c);
+  if (*c.p == '-') {
+    c.p++;
+    return parseUnary(c) && emit(c, OP_NEG, 0);
+  }
+  return parsePrimary(c);
+}
+
+static bool parseTerm(Compiler &c) {
+  if (!parseUnary(c)) return false;
+  for (;;) {
+    skipSpaces(c);
+    char op = *c.p;
+    if (op != '*' && op != '/') return true;
+    c.p++;
+    if (!parseUnary(c) || !emit(c, op == '*' ? OP_MUL : OP_DIV, -1)) return false;
+  }
+}
+
+static bool parseExpression(Compiler &c) {
+  if (!parseTerm(c)) return false;
+  for (;;) {
+    skipSpaces(c);
+    char op = *c.p;
+    if (op != '+' && op != '-') return true;
+    c.p++;
+    if (!parseTerm(c) || !emit(c, op == '+' ? OP_ADD : OP_SUB, -1)) return false;
+  }
+}
+
+static bool compileExpression(const char *expression, DerivedProgram &program, const char **error) {
+  memset(&program, 0, sizeof(program));
+  Compiler c = {expression, &program, 0, 0, 0, NULL};
+  bool ok = parseExpression(c);
+  skipSpaces(c);
+  if (ok && *c.p) {
+    ok = fail(c, "Unexpected character");
+  }
+  if (!ok) {
+    if (error) *error = c.error;
+    memset(&program, 0, sizeof(program));
+    return false;
+  }
+  program.code[c.length] = OP_END;
+  program.valid = true;
+  return true;
+}
+
+bool checkDerivedExpression(const char *expression, const char **error) {
+  DerivedProgram scratch;
+  if (!expression[0]) {
+    return true;  // Empty clears the channel
+  }
+  return compileExpression(expression, scratch, error);
+}
+
+// Compile one slot from currentDisplayConfig and hand it to the ingest side.
+// An empty expression disables the channel and counts as success.
+bool compileDerivedChannel(uint8_t slot) {
+  if (slot >= DERIVED_CHANNEL_COUNT) {
+    return false;
+  }
+  const DerivedChannelConfig &config = currentDisplayConfig.derived[slot];
+  DerivedProgram program;
+  const char *error = NULL;
+  bool ok = true;
+  if (config.expression[0]) {
+    ok = compileExpression(config.expression, program, &error);
+  } else {
+    memset(&program, 0, sizeof(program));
+  }
+
+  // channelInfo changes at the swap, so the old program keeps scaling with its own decimals
+  program.name = config.name[0] ? config.name : NULL;
+  program.decimals = config.decimals;
+
+  portENTER_CRITICAL(&programMux);
+  pendingPrograms[slot] = program;
+  compileErrors[slot] = error;
+  programsPending = true;
+  portEXIT_CRITICAL(&programMux);
+
+  if (!ok) {
+    Serial.printf("[DERIVED] %s: %s in \"%s\"\n", config.name[0] ? config.name : channelInfo[DATA_SOURCE_DERIVED_1 + slot].name,
+                  error, config.expression);
+  }
+  return ok;
+}
+
+void compileDerivedChannels() {
+  for (uint8_t i = 0; i < DERIVED_CHANNEL_COUNT; i++) {
+    compileDerivedChannel(i);
+  }
+}
+
+// Channels a derived data source reads, so pollers can request them even if no panel shows them
+uint32_t getDerivedInputMask(uint8_t dataSource) {
+  if (dataSource < DATA_SOURCE_DERIVED_1 || dataSource >= DATA_SOURCE_COUNT) {
+    return 0;
+  }
+  return pendingPrograms[dataSource - DATA_SOURCE_DERIVED_1].inputMask;
+}
+
+// ---- Evaluator ----
+
+// The compiler guarantees OP_END within DERIVED_CODE_LEN and depth <= DERIVED_STACK_DEPTH
+static bool runProgram(const DerivedProgram &program, const ChannelTable &channels, float &result) {
+  float stack[DERIVED_STACK_DEPTH];
+  uint8_t sp = 0;
+  uint8_t pc = 0;
+  for (;;) {
+    switch (program.code[pc++]) {
+      case OP_END:
+        result = stack[0];
+        return isfinite(result) && fabsf(result) < 2.0e9f;
+      case OP_CONST:
+        stack[sp++] = program.constants[program.code[pc++]];
+        break;
+      case OP_CHANNEL: {
+        uint8_t channel = program.code[pc++];
+        stack[sp++] = channels.value[channel] / fixedScale[channelInfo[channel].decimals];
+        break;
+      }
+      case OP_ADD: sp--; stack[sp - 1] += stack[sp]; break;
+      case OP_SUB: sp--; stack[sp - 1] -= stack[sp]; break;
+      case OP_MUL: sp--; stack[sp - 1] *= stack[sp]; break;
+      case OP_DIV: sp--; stack[sp - 1] /= stack[sp]; break;   // x/0 gives inf, rejected at OP_END
+      case OP_NEG: stack[sp - 1] = -stack[sp - 1]; break;
+      case OP_MIN: sp--; stack[sp - 1] = fminf(stack[sp - 1], stack[sp]); break;
+      case OP_MAX: sp--; stack[sp - 1] = fmaxf(stack[sp - 1], stack[sp]); break;
+      case OP_ABS: stack[sp - 1] = fabsf(stack[sp - 1]); break;
+      default:
+        return false;
+    }
+  }
+}
+
+// Ingest side, called before each publish. A program runs only when one of its
+// inputs changed since the last pass; inputs that were re-sent with the same value
+// just refresh the derived channel's timestamp so it doesn't go stale. A program waits
+// until every input has been received at least once, so a fresh boot doesn't show
+// e.g. Boost computed from MAP = 0.
+// Worst case per pass: DERIVED_CHANNEL_COUNT programs of DERIVED_CODE_LEN bytes.
+void evaluateDerivedChannels(uint32_t nowMs) {
+  if (programsPending) {
+    portENTER_CRITICAL(&programMux);
+    memcpy(activePrograms, pendingPrograms, sizeof(activePrograms));
+    programsPending = false;
+    portEXIT_CRITICAL(&programMux);
+    for (uint8_t slot = 0; slot < DERIVED_CHANNEL_COUNT; slot++) {
+      ChannelInfo &info = channelInfo[DATA_SOURCE_DERIVED_1 + slot];
+      if (activePrograms[slot].name) {
+        info.name = activePrograms[slot].name;
+      }
+      info.decimals = activePrograms[slot].decimals;
+      rerunPending[slot] = true;
+    }
+  }
+
+  uint32_t start = micros();
+  const ChannelTable &channels = getIngestChannels();
+  uint32_t changed = 0;
+  uint32_t updated = 0;
+  uint32_t unseen = 0;
+  for (uint8_t ch = 0; ch < DATA_SOURCE_DERIVED_1; ch++) {
+    if (channels.updatedMs[ch] == 0) {
+      unseen |= (1UL << ch);
+    }
+    if (channels.changes[ch] != lastChanges[ch]) {
+      lastChanges[ch] = channels.changes[ch];
+      changed |= (1UL << ch);
+    }
+    if (channels.updatedMs[ch] != lastUpdated[ch]) {
+      lastUpdated[ch] = channels.updatedMs[ch];
+      updated |= (1UL << ch);
+    }
+  }
+
+  bool ran = false;
+  for (uint8_t slot = 0; slot < DERIVED_CHANNEL_COUNT; slot++) {
+    const DerivedProgram &program = activePrograms[slot];
+    if (!program.valid) {
+      continue;
+    }
+    if (program.inputMask & unseen) {
+      continue;
+    }
+    uint8_t channel = DATA_SOURCE_DERIVED_1 + slot;
+    if (rerunPending[slot] || (program.inputMask & changed)) {
+      rerunPending[slot] = false;
+      float result;
+      resultValid[slot] = runProgram(program, channels, result);
+      if (resultValid[slot]) {
+        writeChannel(channel, lroundf(result * fixedScale[channelInfo[channel].decimals]), nowMs);
+      }
+      evaluationCount++;
+      ran = true;
+    } else if ((program.inputMask & updated) && resultValid[slot]) {
+      writeChannel(channel, channels.raw[channel], nowMs);
+      skippedCount++;
+    }
+  }
+
+  if (ran) {
+    lastPassUs = micros() - start;
+    if (lastPassUs > maxPassUs) maxPassUs = lastPassUs;
+    totalPassUs += lastPassUs;
+    evaluationPasses++;
+  }
+}
+
+String getDerivedJson() {
+  String json = "{";
+  json += "\"evaluations\":" + String(evaluationCount) + ",";
+  json += "\"skipped\":" + String(skippedCount) + ",";
+  json += "\"lastPassUs\":" + String(lastPassUs) + ",";
+  json += "\"maxPassUs\":" + String(maxPassUs) + ",";
+  json += "\"avgPassUs\":" + String(evaluationPasses ? totalPassUs / evaluationPasses : 0) + ",";
+  json += "\"channels\":[";
+  for (uint8_t i = 0; i < DERIVED_CHANNEL_COUNT; i++) {
+    const DerivedChannelConfig &config = currentDisplayConfig.derived[i];
+    if (i > 0) json += ",";
+    json += "{\"dataSource\":" + String(DATA_SOURCE_DERIVED_1 + i) + ",";
+    json += "\"name\":\"" + String(config.name) + "\",";
+    json += "\"expression\":\"" + String(config.expression) + "\",";
+    json += "\"decimals\":" + String(config.decimals) + ",";
+    json += "\"valid\":" + String(pendingPrograms[i].valid ? "true" : "false") + ",";
+    json += "\"error\":\"" + String(compileErrors[i] ? compileErrors[i] : "") + "\"}";
+  }
+  json += "]}";
+  return json;
+}
@@ -0,0 +1,24 @@
+#ifndef DERIVED_CHANNELS_H
+#define DERIVED_CHANNELS_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "DisplayConfig.h"
+
+// Expression language for derived data sources:
+//   numbers, channel names (RPM, MAP, AFR, CLT, BAT, ...), + - * / and
+//   unary minus, parentheses, min(a, b), max(a, b), abs(a).
+// Channel names read the value in its display unit, e.g. AFR = 14.7.
+#define DERIVED_CODE_LEN 48        // Bytecode bytes per expression
+#define DERIVED_MAX_CONSTANTS 8
+#define DERIVED_STACK_DEPTH 8
+
+// Function declarations
+void compileDerivedChannels();
+bool compileDerivedChannel(uint8_t slot);
+bool checkDerivedExpression(const char *expression, const char **error);
+void evaluateDerivedChannels(uint32_t nowMs);
+uint32_t getDerivedInputMask(uint8_t dataSource);
+String getDerivedJson();
+
+#endif // DERIVED_CHANNELS_H
@@ -1,6 +1,10 @@
 #include "DisplayConfig.h"
-#include "DataTypes.h"
+#include "Telemetry.h"
 #include "Config.h"
+#include "CANProtocols.h"
+#include "DerivedChannels.h"
+#include "AlarmRules.h"
+#include "ChannelFilter.h"
 #include <EEPROM.h>
 #include <TFT_eSPI.h>
 
@@ -32,14 +36,90 @@ DisplayConfiguration defaultDisplayConfig = {
   6, // activeIndicatorCount - Updated to 6 (only enabled indicators)
   0, // rpmDisplayMode (bar)
   true, // showSystemIndicators
-  500000 // canSpeed default 500Kbps
+  500000, // canSpeed default 500Kbps
+  DISPLAY_CONFIG_MAGIC,
+  DISPLAY_CONFIG_VERSION,
+  CAN_PROTOCOL_AUTO, // canProtocol - sniff the bus at boot
+  // Derived channels
+  {
+    {"Boost", "(MAP - 101.3) * 0.145", 1},   // psi above atmosphere
+    {"Lambda", "AFR / 14.7", 2},
+    {"", "", 0},
+    {"", "", 0}
+  },
+  // Alarm rules: flags, warnLow, warnHigh, critLow, critHigh, hysteresis, debounceMs
+  {
+    {ALARM_WARN_HIGH | ALARM_CRIT_HIGH, 0, 400, 0, 600, 20, 1000},                  // IAT 40 / 60 C
+    {ALARM_WARN_HIGH | ALARM_CRIT_HIGH, 0, 950, 0, 1100, 20, 1000},                 // Coolant 95 / 110 C
+    {ALARM_WARN_LOW | ALARM_WARN_HIGH | ALARM_CRIT_HIGH, 130, 147, 0, 152, 2, 300},  // AFR outside 13.0-14.7, lean > 15.2
+    {ALARM_CRIT_LOW, 0, 0, 0, 0, 0, 0},                                              // ADV below 0
+    {0, 0, 0, 0, 0, 0, 0},                                                           // Trigger
+    {ALARM_WARN_HIGH | ALARM_CRIT_HIGH, 0, 800, 0, 1000, 10, 0},                    // TPS 80 / 100 %
+    {ALARM_WARN_LOW | ALARM_WARN_HIGH | ALARM_CRIT_LOW, 125, 148, 120, 0, 2, 500},   // Voltage 12.5-14.8, crit < 12.0
+    {ALARM_WARN_HIGH | ALARM_CRIT_HIGH, 0, 800, 0, 1000, 20, 300},                  // MAP 80 / 100 kPa
+    {ALARM_WARN_HIGH | ALARM_CRIT_HIGH, 0, 4000, 0, 6000, 100, 0},                  // RPM
+    {ALARM_WARN_LOW | ALARM_CRIT_LOW, 300, 0, 280, 0, 5, 300},                       // FP 30 / 28 psi
+    {0, 0, 0, 0, 0, 0, 0},                                                           // VSS
+    {0, 0, 0, 0, 0, 0, 0},                                                           // Derived 1-4
+    {0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0}
+  },
+  // Filters: the noisy sensors are smoothed, the rest pass through
+  {
+    {FILTER_NONE, 0},       // IAT
+    {FILTER_NONE, 0},       // Coolant
+    {FILTER_EMA, 2},        // AFR
+    {FILTER_NONE, 0},       // ADV
+    {FILTER_NONE, 0},       // Trigger
+    {FILTER_NONE, 0},       // TPS
+    {FILTER_DEADBAND, 1},   // Voltage, ignore 0.1 V flicker
+    {FILTER_MEDIAN, 3},     // MAP
+    {FILTER_NONE, 0},       // RPM
+    {FILTER_NONE, 0},       // FP
+    {FILTER_NONE, 0},       // VSS
+    {FILTER_NONE, 0},       // Derived 1-4
+    {FILTER_NONE, 0},
+    {FILTER_NONE, 0},
+    {FILTER_NONE, 0}
+  }
 };
 
+static_assert(sizeof(DisplayConfiguration) + 10 <= EEPROM_SIZE, "Display configuration does not fit in EEPROM");
+
 DisplayConfiguration currentDisplayConfig;
 
 void initializeDisplayConfig() {
   // Load configuration from EEPROM or use default
   loadDisplayConfig();
+  compileDerivedChannels();
+  compileAlarmRules();
+}
+
+// Default every block appended after the version the config was saved with.
+// Saves from before versioning have no magic: arduino-esp32 zero-fills EEPROM it
+// grows, so those bytes are 0x00 rather than anything recognisable.
+static bool migrateDisplayConfig(DisplayConfiguration &config) {
+  uint8_t version = (config.magic == DISPLAY_CONFIG_MAGIC) ? config.version : 0;
+  if (version == DISPLAY_CONFIG_VERSION) {
+    return false;
+  }
+  Serial.printf("[CONFIG] Migrating display configuration from version %u to %u\n", version, DISPLAY_CONFIG_VERSION);
+  if (version < CONFIG_VERSION_CAN_PROTOCOL) {
+    config.canProtocol = defaultDisplayConfig.canProtocol;
+  }
+  if (version < CONFIG_VERSION_DERIVED) {
+    memcpy(config.derived, defaultDisplayConfig.derived, sizeof(config.derived));
+  }
+  if (version < CONFIG_VERSION_ALARMS) {
+    memcpy(config.alarms, defaultDisplayConfig.alarms, sizeof(config.alarms));
+  }
+  if (version < CONFIG_VERSION_FILTERS) {
+    memcpy(config.filters, defaultDisplayConfig.filters, sizeof(config.filters));
+  }
+  config.magic = DISPLAY_CONFIG_MAGIC;
+  config.version = DISPLAY_CONFIG_VERSION;
+  return true;
 }
 
 void saveDisplayConfig() {
@@ -58,7 +138,15 @@ void loadDisplayConfig() {
   // Also force reset if activeIndicatorCount != 6 to apply new indicator config
   if (tempConfig.activePanelCount <= 9 && tempConfig.activeIndicatorCount <= 8 && tempConfig.activeIndicatorCount == 6) {
     currentDisplayConfig = tempConfig;
+    bool migrated = migrateDisplayConfig(currentDisplayConfig);
+    for (uint8_t i = 0; i < DERIVED_CHANNEL_COUNT; i++) {
+      currentDisplayConfig.derived[i].name[DERIVED_NAME_LEN - 1] = '\0';
+      currentDisplayConfig.derived[i].expression[DERIVED_EXPRESSION_LEN - 1] = '\0';
+    }
     Serial.println("Display configuration loaded from EEPROM");
+    if (migrated) {
+      saveDisplayConfig();
+    }
   } else {
     // Use default configuration and reset EEPROM
     currentDisplayConfig = defaultDisplayConfig;
@@ -73,73 +161,16 @@ void resetDisplayConfigToDefault() {
   Serial.println("Display configuration reset to default");
 }
 
-float getDataValue(uint8_t dataSource) {
-  switch (dataSource) {
-    case DATA_SOURCE_IAT:
-      return (float)iat;
-    case DATA_SOURCE_COOLANT:
-      return (float)clt;
-    case DATA_SOURCE_AFR:
-      return afrConv;
-    case DATA_SOURCE_ADV:
-      return (float)adv;
-    case DATA_SOURCE_TRIGGER:
-      return (float)triggerError;
-    case DATA_SOURCE_TPS:
-      return (float)tps;
-    case DATA_SOURCE_VOLTAGE:
-      return bat;
-    case DATA_SOURCE_MAP:
-      return (float)mapData;
-    case DATA_SOURCE_RPM:
-      return (float)rpm;
-    case DATA_SOURCE_FP:
-      return (float)fp;
-    case DATA_SOURCE_VSS:
-      return (float)vss;
-    default:
-      return 0.0;
-  }
-}
-
+// Indicator state from the snapshot latched for the current frame
 bool getIndicatorValue(uint8_t indicator) {
-  switch (indicator) {
-    case INDICATOR_SYNC:
-      return syncStatus;
-    case INDICATOR_FAN:
-      return fan;
-    case INDICATOR_ASE:
-      return ase;
-    case INDICATOR_WUE:
-      return wue;
-    case INDICATOR_REV:
-      return rev;
-    case INDICATOR_LCH:
-      return launch;
-    case INDICATOR_AC:
-      return airCon;
-    case INDICATOR_DFCO:
-      return dfco;
-    default:
-      return false;
+  if (indicator >= INDICATOR_COUNT) {
+    return false;
   }
+  return getFrameTelemetry().channels.indicators & (1UL << indicator);
 }
 
 const char* getDataSourceName(uint8_t dataSource) {
-  switch (dataSource) {
-    case DATA_SOURCE_IAT: return "IAT";
-    case DATA_SOURCE_COOLANT: return "Coolant";
-    case DATA_SOURCE_AFR: return "AFR";
-    case DATA_SOURCE_ADV: return "ADV";
-    case DATA_SOURCE_TRIGGER: return "Trigger";
-    case DATA_SOURCE_TPS: return "TPS";
-    case DATA_SOURCE_VOLTAGE: return "Voltage";
-    case DATA_SOURCE_MAP: return "MAP";
-    case DATA_SOURCE_RPM: return "RPM";
-    case DATA_SOURCE_FP: return "FP";
-    case DATA_SOURCE_VSS: return "VSS";
-    default: return "Unknown";
-  }
+  return dataSource < DATA_SOURCE_COUNT ? channelInfo[dataSource].name : "Unknown";
 }
 
 const char* getIndicatorName(uint8_t indicator) {
@@ -156,24 +187,13 @@ const char* getIndicatorName(uint8_t indicator) {
   }
 }
 
-uint16_t getDataSourceColor(uint8_t dataSource, float value) {
-  switch (dataSource) {
-    case DATA_SOURCE_AFR:
-      return (value < 13.0) ? TFT_ORANGE : ((value > 14.7) ? TFT_RED : TFT_GREEN);
-    case DATA_SOURCE_COOLANT:
-      return (value > 95) ? TFT_RED : TFT_WHITE;
-    case DATA_SOURCE_VOLTAGE:
-      return (value < 11.5 || value > 14.5) ? TFT_ORANGE : TFT_GREEN;
-    case DATA_SOURCE_ADV:
-      return TFT_RED;
-    default:
-      return TFT_WHITE;
-  }
+bool isValidCanSpeed(uint32_t speed) {
+  return speed == 1000000 || speed == 500000 || speed == 250000 || speed == 125000;
 }
 
 uint32_t getCanSpeed() {
   // Prioritas: 1Mbps (umum untuk Speeduino), fallback ke 500k
-  if (currentDisplayConfig.canSpeed == 500000 || currentDisplayConfig.canSpeed == 1000000) {
+  if (isValidCanSpeed(currentDisplayConfig.canSpeed)) {
     return currentDisplayConfig.canSpeed;
   } else {
     // Default untuk Speeduino biasanya 1Mbps, coba dulu
@@ -183,7 +203,7 @@ uint32_t getCanSpeed() {
 }
 
 void setCanSpeed(uint32_t speed) {
-  if (speed == 500000 || speed == 1000000) {
+  if (isValidCanSpeed(speed)) {
     currentDisplayConfig.canSpeed = speed;
     saveDisplayConfig();
     Serial.printf("[CONFIG] CAN speed set to %u bps and saved\n", speed);
@@ -191,3 +211,64 @@ void setCanSpeed(uint32_t speed) {
     Serial.printf("[CONFIG] Invalid CAN speed %u, keeping current\n", speed);
   }
 }
+
+uint8_t getCanProtocol() {
+  uint8_t protocol = currentDisplayConfig.canProtocol;
+  if (protocol < CAN_PROTOCOL_COUNT || protocol == CAN_PROTOCOL_AUTO) {
+    return protocol;
+  }
+  return CAN_PROTOCOL_AUTO;  // Corrupt value, older saves are migrated in loadDisplayConfig()
+}
+
+void setCanProtocol(uint8_t protocol) {
+  if (protocol < CAN_PROTOCOL_COUNT || protocol == CAN_PROTOCOL_AUTO) {
+    currentDisplayConfig.canProtocol = protocol;
+    saveDisplayConfig();
+    Serial.printf("[CONFIG] CAN protocol set to %u and saved\n", protocol);
+  } else {
+    Serial.printf("[CONFIG] Invalid CAN protocol %u, keeping current\n", protocol);
+  }
+}
+
+// Replace a derived channel's expression; rejected (and not saved) if it doesn't compile
+bool setDerivedChannel(uint8_t slot, const char *name, const char *expression, uint8_t decimals) {
+  if (slot >= DERIVED_CHANNEL_COUNT || decimals > 3 ||
+      strlen(name) >= DERIVED_NAME_LEN || strlen(expression) >= DERIVED_EXPRESSION_LEN ||
+      strpbrk(name, "\"\\") || !checkDerivedExpression(expression, NULL)) {
+    return false;
+  }
+  DerivedChannelConfig previous = currentDisplayConfig.derived[slot];
+  DerivedChannelConfig &derived = currentDisplayConfig.derived[slot];
+  strcpy(derived.name, name);
+  strcpy(derived.expression, expression);
+  derived.decimals = decimals;
+  if (!compileDerivedChannel(slot)) {
+    derived = previous;
+    compileDerivedChannel(slot);
+    return false;
+  }
+  saveDisplayConfig();
+  Serial.printf("[CONFIG] Derived channel %u set to %s = %s\n", slot + 1, name, expression);
+  return true;
+}
+
+bool setAlarmRule(uint8_t dataSource, const AlarmRuleConfig &rule) {
+  if (dataSource >= DATA_SOURCE_COUNT || (rule.flags & ~ALARM_FLAG_MASK)) {
+    return false;
+  }
+  currentDisplayConfig.alarms[dataSource] = rule;
+  compileAlarmRule(dataSource);
+  saveDisplayConfig();
+  Serial.printf("[CONFIG] Alarm rule for %s set and saved\n", getDataSourceName(dataSource));
+  return true;
+}
+
+bool setChannelFilter(uint8_t dataSource, uint8_t type, uint8_t param) {
+  if (dataSource >= DATA_SOURCE_COUNT || !isValidFilter(type, param)) {
+    return false;
+  }
+  storeFilterConfig(dataSource, type, (type == FILTER_NONE) ? 0 : param);
+  saveDisplayConfig();
+  Serial.printf("[CONFIG] Filter for %s set to type %u param %u and saved\n", getDataSourceName(dataSource), type, param);
+  return true;
+}
@@ -24,9 +24,17 @@ enum DataSource {
   DATA_SOURCE_RPM,
   DATA_SOURCE_FP,
   DATA_SOURCE_VSS,
+  DATA_SOURCE_DERIVED_1,  // Computed from other channels, see DerivedChannels.h
+  DATA_SOURCE_DERIVED_2,
+  DATA_SOURCE_DERIVED_3,
+  DATA_SOURCE_DERIVED_4,
   DATA_SOURCE_COUNT
 };
 
+#define DERIVED_CHANNEL_COUNT (DATA_SOURCE_COUNT - DATA_SOURCE_DERIVED_1)
+#define DERIVED_NAME_LEN 8
+#define DERIVED_EXPRESSION_LEN 48
+
 // Indicator sources
 enum IndicatorSource {
   INDICATOR_SYNC,
@@ -60,6 +68,47 @@ struct IndicatorConfig {
   char label[6];          // Label to display
 };
 
+// User expression for a derived data source, e.g. "(MAP - 101.3) * 0.145"
+struct DerivedChannelConfig {
+  char name[DERIVED_NAME_LEN];              // Shown as the panel label
+  char expression[DERIVED_EXPRESSION_LEN];  // Empty = channel unused
+  uint8_t decimals;                         // Fixed-point scale of the result
+};
+
+// Alarm bands for one channel, in the channel's fixed-point units (see channelInfo[].decimals).
+// A bound is active when its flag is set: value < low or value > high enters the band.
+#define ALARM_WARN_LOW   0x01
+#define ALARM_WARN_HIGH  0x02
+#define ALARM_CRIT_LOW   0x04
+#define ALARM_CRIT_HIGH  0x08
+#define ALARM_FLAG_MASK  0x0F
+
+struct AlarmRuleConfig {
+  uint8_t flags;
+  int16_t warnLow;
+  int16_t warnHigh;
+  int16_t critLow;
+  int16_t critHigh;
+  uint16_t hysteresis;   // Distance back past a bound before the band is left
+  uint16_t debounceMs;   // A new severity must hold this long before it shows
+};
+
+// Ingest-side smoothing for one channel, see ChannelFilter.h. Aligned so the pair
+// is read and written as one 16-bit word (loadFilterConfig/storeFilterConfig).
+struct alignas(uint16_t) ChannelFilterConfig {
+  uint8_t type;     // FilterType
+  uint8_t param;
+};
+
+// Stored layout version. Blocks are only ever appended; each bump names the block it
+// added so loadDisplayConfig() can default exactly the blocks an older save never wrote.
+#define DISPLAY_CONFIG_MAGIC 0x44434647UL    // "DCFG"
+#define CONFIG_VERSION_CAN_PROTOCOL 1
+#define CONFIG_VERSION_DERIVED      2
+#define CONFIG_VERSION_ALARMS       3
+#define CONFIG_VERSION_FILTERS      4
+#define DISPLAY_CONFIG_VERSION CONFIG_VERSION_FILTERS
+
 // Main display configuration
 struct DisplayConfiguration {
   DisplayPanel panels[9];           // 9 data panels (increased from 8)
@@ -69,6 +118,13 @@ struct DisplayConfiguration {
   uint8_t rpmDisplayMode;           // RPM display mode (0=bar, 1=digital)
   bool showSystemIndicators;        // Show CAN/SER, DEBUG, SIM
   uint32_t canSpeed;                // CAN speed in bps (e.g. 500000, 1000000)
+  // Everything below was appended after the first release
+  uint32_t magic;                   // DISPLAY_CONFIG_MAGIC once versioned
+  uint8_t version;                  // DISPLAY_CONFIG_VERSION at save time
+  uint8_t canProtocol;              // CANProtocolId, or CAN_PROTOCOL_AUTO
+  DerivedChannelConfig derived[DERIVED_CHANNEL_COUNT];
+  AlarmRuleConfig alarms[DATA_SOURCE_COUNT];   // Indexed by DataSource
+  ChannelFilterConfig filters[DATA_SOURCE_COUNT];
 };
 
 // Default configuration
@@ -80,13 +136,17 @@ void initializeDisplayConfig();
 void saveDisplayConfig();
 void loadDisplayConfig();
 void resetDisplayConfigToDefault();
-float getDataValue(uint8_t dataSource);
 bool getIndicatorValue(uint8_t indicator);
 const char* getDataSourceName(uint8_t dataSource);
 const char* getIndicatorName(uint8_t indicator);
-uint16_t getDataSourceColor(uint8_t dataSource, float value);
 // New CAN speed accessors
+bool isValidCanSpeed(uint32_t speed);
 uint32_t getCanSpeed();
 void setCanSpeed(uint32_t speed);
+uint8_t getCanProtocol();
+void setCanProtocol(uint8_t protocol);
+bool setDerivedChannel(uint8_t slot, const char *name, const char *expression, uint8_t decimals);
+bool setAlarmRule(uint8_t dataSource, const AlarmRuleConfig &rule);
+bool setChannelFilter(uint8_t dataSource, uint8_t type, uint8_t param);
 
 #endif // DISPLAY_CONFIG_H
@@ -2,7 +2,15 @@
 #include "Config.h"
 #include "DataTypes.h"
 #include "DisplayConfig.h"
+#include "Telemetry.h"
+#include "AlarmRules.h"
+#include "SessionPeaks.h"
+#include "ChannelFilter.h"
+#include "Compositor.h"
+#include "RenderTask.h"
+#include "GlyphAtlas.h"
 #include "drawing_utils.h"
+#include "text_utils.h"
 #include "SplashScreen.h"
 #include "NotoSans_Bold6pt7b.h"
 #include "NotoSans_Bold16pt7b.h"
@@ -21,6 +29,42 @@ TFT_eSprite spr = TFT_eSprite(&display);
 // Display settings
 bool isColorFull = false;
 
+// Render-path sprites: one value sprite per panel position, used as that panel's layer
+// in the compositor. Allocated when the layout is set up and reused every frame, so
+// driving around doesn't malloc/free several KB per panel redraw and fragment the heap.
+static TFT_eSprite *panelSprites[9];
+static uint32_t layoutSpriteAllocations = 0;   // Layout setup and panel reconfiguration
+static uint32_t renderSpriteAllocations = 0;   // Inside a frame: stays 0 in steady state
+static uint32_t panelSpriteBytes = 0;
+static volatile bool panelLayoutPending = false;
+static volatile bool benchmarkPending = false;
+
+// The render task draws from its own copy of the layout. Web handlers edit
+// currentDisplayConfig from loop(), which the render task can preempt mid-edit,
+// then hand the finished layout over with requestPanelLayout().
+struct PanelLayout {
+  DisplayPanel panels[9];
+  IndicatorConfig indicators[8];
+  uint8_t panelCount;
+  uint8_t indicatorCount;
+};
+static PanelLayout renderLayout;
+static PanelLayout pendingLayout;
+static portMUX_TYPE layoutMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Compositor widgets: a label and a value layer per panel plus the top-row overlays
+static const char *panelLabels[9];
+static int8_t labelWidgets[9];
+static int8_t valueWidgets[9];
+static int8_t peakWidget = -1;
+static int8_t simWidget = -1;
+static int8_t debugWidget = -1;
+static String debugOverlayText;
+
+// Text currently in each panel's value sprite, see drawNumericField()
+#define NUMERIC_FIELD_LEN 12
+static char shownText[9][NUMERIC_FIELD_LEN];
+
 void setupDisplay() {
   display.init();
   display.setRotation(3);
@@ -28,36 +72,52 @@ void setupDisplay() {
   initializeDisplayConfig();
 }
 
-void drawSplashScreenWithImage() {
-  // Use the new modular animated splash screen
-  showAnimatedSplashScreen();
+// Value color for an alarm severity. Warn/critical show in either theme (the old
+// label-based colors only did with isColorFull); normal values keep the theme color.
+static uint16_t getSeverityColor(uint8_t severity) {
+  switch (severity) {
+    case SEVERITY_CRITICAL: return TFT_RED;
+    case SEVERITY_WARN: return TFT_YELLOW;
+    default: return isColorFull ? TFT_GREEN : TFT_ORANGE;
+  }
 }
 
-// Forward declarations
-void drawDynamicDataPanel(const DisplayPanel &panel, bool setup);
-void drawRPMPanel(int x, int y, const char *label, unsigned int value, uint16_t color, unsigned int lastValue, bool setup);
-void drawIntPanel(int x, int y, const char *label, int value, uint16_t color, int lastValue, bool setup);
-void drawFloatPanel(int x, int y, const char *label, float value, uint16_t color, float lastValue, int decimals, bool setup);
-void addDataPanel(int position, const char* label, uint8_t dataSource, bool enabled, int decimals);
-void addIndicator(int position, const char* label, uint8_t indicator, bool enabled);
-void lablDraw(int x, int y, const char *label, int type);
-
-void drawConfigurablePanels(bool setup) {
-  // Draw each enabled panel using stored coordinates
-  for (int i = 0; i < currentDisplayConfig.activePanelCount; i++) {
-    DisplayPanel &panel = currentDisplayConfig.panels[i];
-    if (panel.enabled) {
-      drawDynamicDataPanel(panel, setup);
+// Make `sprite` exactly w x h, allocating only if it isn't already
+static bool ensureSprite(TFT_eSprite &sprite, int16_t w, int16_t h, uint32_t &allocations) {
+  if (sprite.created()) {
+    if (sprite.width() == w && sprite.height() == h) {
+      return true;
     }
+    sprite.deleteSprite();
   }
+  allocations++;
+  sprite.setColorDepth(16);
+  return sprite.createSprite(w, h) != nullptr;
 }
 
-// New dynamic panel drawing function using position mapping
-void drawDynamicDataPanel(const DisplayPanel &panel, bool setup) {
+// Value sprite size for the kind of panel drawn at a position
+static void getPanelSpriteSize(const DisplayPanel &panel, int16_t &w, int16_t &h) {
+  if (panel.dataSource == DATA_SOURCE_RPM) {
+    w = 90; h = 40;
+  } else if (panel.decimals > 0) {
+    w = 70; h = 38;
+  } else {
+    w = 64; h = 38;
+  }
+}
+
+static void renderPanelLabel(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id);
+static void renderPanelValue(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id);
+static void renderPeakTag(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id);
+static void renderSimTag(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id);
+static void renderDebugOverlay(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id);
+
+// Panel origin on the 320x170 screen for a position (0-8)
+static void getPanelOrigin(uint8_t position, int &x, int &y) {
   // Panel positions for 320x170 display - 9 panels layout (4+5)
   // Top row (4 panels): CLT, IAT, AFR, BAT  
   // Bottom row (5 panels): RPM, FP, TPS, MAP, ADV
-  const int panelPositions[9][2] = {
+  static const int panelPositions[9][2] = {
     // Baris atas (4 panel) - Width per panel: 320/4 = 80px
     {0, 10},    // Position 0: CLT (top row)
     {70, 10},   // Position 1: IAT (top row) 
@@ -71,187 +131,403 @@ void drawDynamicDataPanel(const DisplayPanel &panel, bool setup) {
     {202, 80},  // Position 7: MAP (bottom row)
     {256, 80}   // Position 8: ADV (bottom row) - exact 64px spacing
   };
+  x = panelPositions[position][0];
+  y = panelPositions[position][1];
+}
+
+// Size every enabled panel's sprite for the active layout, free unused ones and
+// register the panels and overlays with the compositor
+static void allocatePanelSprites() {
+  bool used[9] = {false};
+  panelSpriteBytes = 0;
+  clearCompositorWidgets();
+  for (int i = 0; i < 9; i++) {
+    labelWidgets[i] = -1;
+    valueWidgets[i] = -1;
+    shownText[i][0] = '\0';   // Sprites may have been resized: next draw is a full one
+  }
+  display.setFreeFont(AA_FONT_FREE_SMALL);
+  for (int i = 0; i < renderLayout.panelCount; i++) {
+    const DisplayPanel &panel = renderLayout.panels[i];
+    if (!panel.enabled || panel.position >= 9) {
+      continue;
+    }
+    if (!panelSprites[panel.position]) {
+      panelSprites[panel.position] = new TFT_eSprite(&display);
+    }
+    int16_t w, h;
+    getPanelSpriteSize(panel, w, h);
+    if (ensureSprite(*panelSprites[panel.position], w, h, layoutSpriteAllocations)) {
+      panelSpriteBytes += w * h * 2;
+    }
+    used[panel.position] = true;
+    
+    // Label is centred 25px into the panel; value layer sits 20px below the panel top
+    int x, y;
+    getPanelOrigin(panel.position, x, y);
+    int16_t labelW = display.textWidth(panel.label);
+    panelLabels[panel.position] = panel.label;
+    labelWidgets[panel.position] = addCompositorWidget(x + 25 - labelW / 2, y + 5, labelW, display.fontHeight(), renderPanelLabel, panel.position);
+    valueWidgets[panel.position] = addCompositorWidget(x, y + 20, w, h, renderPanelValue, panel.position);
+  }
+  for (int i = 0; i < 9; i++) {
+    if (!used[i] && panelSprites[i] && panelSprites[i]->created()) {
+      panelSprites[i]->deleteSprite();
+    }
+  }
+  peakWidget = addCompositorWidget(5, 5, 45, 15, renderPeakTag, 0);
+  simWidget = addCompositorWidget(display.width() - 30, 5, 25, 15, renderSimTag, 0);
+  debugWidget = addCompositorWidget(display.width() / 2 - 120, 5, 240, 20, renderDebugOverlay, 0);
+  initCompositor(layoutSpriteAllocations);
+  initGlyphAtlas(AA_FONT_FREE_MEDIUM, layoutSpriteAllocations);
+  panelSpriteBytes += getGlyphAtlasBytes();
+  panelSpriteBytes += COMPOSITOR_SCRATCH_W * COMPOSITOR_SCRATCH_H * 2 * (isCompositorDMA() ? 2 : 1);
   
+  // Repaint the whole panel area so panels that moved or went away leave nothing behind
+  markRegionDirty(0, 0, display.width(), 150);
+  Serial.printf("[DISPLAY] Panel sprites ready: %u bytes, %u allocations so far\n", panelSpriteBytes, layoutSpriteAllocations);
+}
+
+// Serial 'b': the render task runs the benchmark after its next frame
+void requestPanelRedrawBenchmark() {
+  benchmarkPending = true;
+}
+
+// Panel config changed (web UI): copy it for the render task, which resizes
+// sprites before its next frame
+void requestPanelLayout() {
+  portENTER_CRITICAL(&layoutMux);
+  memcpy(pendingLayout.panels, currentDisplayConfig.panels, sizeof(pendingLayout.panels));
+  memcpy(pendingLayout.indicators, currentDisplayConfig.indicators, sizeof(pendingLayout.indicators));
+  pendingLayout.panelCount = currentDisplayConfig.activePanelCount > 9 ? 9 : currentDisplayConfig.activePanelCount;
+  pendingLayout.indicatorCount = currentDisplayConfig.activeIndicatorCount > 8 ? 8 : currentDisplayConfig.activeIndicatorCount;
+  panelLayoutPending = true;
+  portEXIT_CRITICAL(&layoutMux);
+}
+
+static void applyPendingLayout() {
+  portENTER_CRITICAL(&layoutMux);
+  renderLayout = pendingLayout;
+  panelLayoutPending = false;
+  portEXIT_CRITICAL(&layoutMux);
+}
+
+uint32_t getRenderSpriteAllocations() {
+  return renderSpriteAllocations;
+}
+
+uint32_t getLayoutSpriteAllocations() {
+  return layoutSpriteAllocations;
+}
+
+uint32_t getPanelSpriteBytes() {
+  return panelSpriteBytes;
+}
+
+void drawSplashScreenWithImage() {
+  // Use the new modular animated splash screen
+  showAnimatedSplashScreen();
+}
+
+// Forward declarations
+void drawDynamicDataPanel(const DisplayPanel &panel, bool setup);
+void drawRPMPanel(uint8_t panelIndex, TFT_eSprite &sprite, unsigned int value, uint16_t color, unsigned int lastValue, bool setup, bool stale);
+void drawIntPanel(uint8_t panelIndex, TFT_eSprite &sprite, int value, uint16_t color, int lastValue, bool setup, bool stale);
+void drawFloatPanel(uint8_t panelIndex, TFT_eSprite &sprite, int32_t value, uint16_t color, int32_t lastValue, int decimals, bool setup, bool stale);
+void addDataPanel(int position, const char* label, uint8_t dataSource, bool enabled, int decimals);
+void addIndicator(int position, const char* label, uint8_t indicator, bool enabled);
+
+void drawConfigurablePanels(bool setup) {
+  // Draw each enabled panel using stored coordinates
+  for (int i = 0; i < renderLayout.panelCount; i++) {
+    const DisplayPanel &panel = renderLayout.panels[i];
+    if (panel.enabled) {
+      drawDynamicDataPanel(panel, setup);
+    }
+  }
+  // Push whatever the panels and overlays marked dirty, each tile once
+  compositeDirtyTiles();
+}
+
+// Compositor render callbacks: draw at screen position minus the window origin
+static void renderPanelLabel(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id) {
+  int x, y;
+  getPanelOrigin(id, x, y);
+  target.setFreeFont(AA_FONT_FREE_SMALL);
+  target.setTextColor(isColorFull ? TFT_WHITE : TFT_CYAN);
+  target.setTextDatum(TC_DATUM);
+  target.drawString(panelLabels[id], x + 25 - originX, y + 5 - originY);
+}
+
+static void renderPanelValue(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id) {
+  int x, y;
+  getPanelOrigin(id, x, y);
+  // Black is transparent so overlapping neighbours (RPM and position 5) don't clip each other
+  panelSprites[id]->pushToSprite(&target, x - originX, y + 20 - originY, TFT_BLACK);
+}
+
+static void renderPeakTag(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id) {
+  if (isPeakRecallActive()) {
+    target.setFreeFont(AA_FONT_FREE_SMALL);
+    target.setTextColor(TFT_CYAN);
+    target.setTextDatum(TL_DATUM);
+    target.drawString("PEAK", 5 - originX, 5 - originY);
+  }
+}
+
+static void renderSimTag(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id) {
+#if ENABLE_SIMULATOR
+  if (getSimulatorMode() != SIMULATOR_MODE_OFF) {
+    target.setFreeFont(AA_FONT_FREE_SMALL);
+    target.setTextColor(TFT_YELLOW);
+    target.setTextDatum(TR_DATUM);
+    target.drawString("SIM", display.width() - 5 - originX, 5 - originY);
+  }
+#endif
+}
+
+static void renderDebugOverlay(TFT_eSprite &target, int16_t originX, int16_t originY, uint8_t id) {
+  if (debugOverlayText.length() > 0) {
+    target.setFreeFont(AA_FONT_FREE_SMALL);
+    target.setTextColor(TFT_CYAN);
+    target.setTextDatum(TC_DATUM);
+    target.drawString(debugOverlayText, display.width() / 2 - originX, 5 - originY);
+  }
+}
+
+// New dynamic panel drawing function using position mapping
+void drawDynamicDataPanel(const DisplayPanel &panel, bool setup) {
   if (panel.position >= 9) return;
   
-  // Get coordinates from position array
-  int x = panelPositions[panel.position][0];
-  int y = panelPositions[panel.position][1];
-  
-  // Get current value based on data source
-  float currentValue = getDataValue(panel.dataSource);
+  // Channel value scaled to the panel's decimals: redraws only when what is shown changes.
+  // During peak recall the session extreme is shown instead.
+  bool recall = isPeakRecallActive();
+  int32_t channelValue = recall ? getPeakRecallValue(panel.dataSource) : getChannelValue(panel.dataSource);
+  uint8_t channelDecimals = panel.dataSource < CHANNEL_COUNT ? channelInfo[panel.dataSource].decimals : 0;
+  int32_t currentValue = scaleFixed(channelValue, channelDecimals, panel.decimals);
   
-  // Get color based on data source and value
-  uint16_t color = getDataSourceColor(panel.dataSource, currentValue);
+  // Color from the alarm severity computed when the sample arrived
+  uint8_t severity = getChannelSeverity(panel.dataSource);
+  uint16_t color = recall ? TFT_CYAN : getSeverityColor(severity);
   
   // Use static array to track last values for each panel position
-  static float lastValues[9];
+  static int32_t lastValues[9];
+  static bool lastStale[9];
+  static uint16_t lastColor[9];
+  static int32_t lastRawValues[9];   // What the panel would show without the channel filter
   static bool initialized = false;
   
   // Initialize array on first run
   if (!initialized) {
     for (int i = 0; i < 9; i++) {
-      lastValues[i] = -999.0;
+      lastValues[i] = INT32_MIN;
+      lastStale[i] = false;
+      lastColor[i] = 0;
+      lastRawValues[i] = INT32_MIN;
     }
     initialized = true;
   }
   
-  // Only redraw if value changed or setup
+  // Grey out values whose source stopped arriving
   int panelIndex = panel.position < 9 ? panel.position : 0;
-  if (setup || lastValues[panelIndex] != currentValue || first_run) {
+  bool stale = !recall && isChannelStale(panel.dataSource, millis());
+  bool staleChanged = stale != lastStale[panelIndex];
+  bool colorChanged = color != lastColor[panelIndex];
+  
+  // Count frames where the unfiltered value would have forced a redraw the filter avoided
+  if (!recall && panel.dataSource < CHANNEL_COUNT && currentDisplayConfig.filters[panel.dataSource].type != FILTER_NONE) {
+    int32_t rawValue = scaleFixed(getChannelRawValue(panel.dataSource), channelDecimals, panel.decimals);
+    if (rawValue != lastRawValues[panelIndex] && currentValue == lastValues[panelIndex]) {
+      countSavedRedraw();
+    }
+    lastRawValues[panelIndex] = rawValue;
+  }
+  
+  // Labels only change with the layout or theme
+  if (first_run || forceRefresh) {
+    markWidgetDirty(labelWidgets[panelIndex]);
+  }
+  
+  // Only redraw if value, freshness or color (alarm state, peak recall) changed, or setup
+  if (setup || staleChanged || colorChanged || lastValues[panelIndex] != currentValue || first_run) {
+    bool fullRedraw = setup || staleChanged || colorChanged || first_run;
+    
+    // The panel's own sprite; only allocates if the panel was reconfigured since layout
+    if (!panelSprites[panelIndex]) {
+      panelSprites[panelIndex] = new TFT_eSprite(&display);
+    }
+    TFT_eSprite &sprite = *panelSprites[panelIndex];
+    int16_t spriteW, spriteH;
+    getPanelSpriteSize(panel, spriteW, spriteH);
+    if (!ensureSprite(sprite, spriteW, spriteH, renderSpriteAllocations)) {
+      return;
+    }
     
     // For RPM, use special drawing function 
     if (panel.dataSource == DATA_SOURCE_RPM) {
-      drawRPMPanel(x, y, panel.label, (unsigned int)currentValue, color, (unsigned int)lastValues[panelIndex], setup || first_run);
+      drawRPMPanel(panelIndex, sprite, (unsigned int)currentValue, color, (unsigned int)lastValues[panelIndex], fullRedraw, stale);
     } else {
       // Use appropriate drawing function based on decimals
       if (panel.decimals > 0) {
-        drawFloatPanel(x, y, panel.label, currentValue, color, lastValues[panelIndex], panel.decimals, setup || first_run);
+        drawFloatPanel(panelIndex, sprite, currentValue, color, lastValues[panelIndex], panel.decimals, fullRedraw, stale);
       } else {
-        drawIntPanel(x, y, panel.label, (int)currentValue, color, (int)lastValues[panelIndex], setup || first_run);
+        drawIntPanel(panelIndex, sprite, currentValue, color, lastValues[panelIndex], fullRedraw, stale);
       }
     }
     
     lastValues[panelIndex] = currentValue;
+    lastStale[panelIndex] = stale;
+    lastColor[panelIndex] = color;
+  }
+}
+
+// Value text into a panel sprite: blitted from the glyph atlas when it can be,
+// otherwise through the free-font rasterizer
+static void drawValueText(TFT_eSprite &sprite, const char *text, int32_t x, int32_t y, uint8_t datum, uint16_t color) {
+  if (drawAtlasString(sprite, text, x, y, datum, color)) {
+    return;
   }
+  sprite.setFreeFont(AA_FONT_FREE_MEDIUM);
+  sprite.setTextDatum(datum);
+  sprite.setTextColor(color, TFT_BLACK, true);
+  sprite.drawString(text, x, y);
 }
 
-// Specialized drawing functions for different data types
-void drawRPMPanel(int x, int y, const char *label, unsigned int value, uint16_t color, unsigned int lastValue, bool setup) {
-  lablDraw(x, y, label, 0);
+// Numeric field: remembers the text shown in each panel's value sprite and, when only
+// some digits changed, redraws just those glyph cells and marks just them dirty, so
+// 3450 -> 3460 RPM pushes one digit instead of the whole sprite. Values reach here
+// already scaled to the shown decimals, so changes below the displayed precision
+// never get this far.
+static void drawNumericField(uint8_t panelIndex, TFT_eSprite &sprite, const char *text, int32_t x, int32_t y,
+                             uint8_t datum, uint16_t color, bool full) {
+  AtlasCellRect cells[NUMERIC_FIELD_LEN];
+  int8_t changed = -1;
+  if (!full && !forceRefresh && !first_run) {
+    changed = drawAtlasStringDiff(sprite, text, shownText[panelIndex], x, y, datum, color, cells, NUMERIC_FIELD_LEN);
+  }
+  if (changed < 0) {
+    sprite.fillSprite(TFT_BLACK);  // Clear sprite background to prevent artifacts
+    drawValueText(sprite, text, x, y, datum, color);
+    markWidgetDirty(valueWidgets[panelIndex]);
+  } else {
+    int px, py;
+    getPanelOrigin(panelIndex, px, py);
+    for (int8_t i = 0; i < changed; i++) {
+      markRegionDirty(px + cells[i].x, py + 20 + cells[i].y, cells[i].w, cells[i].h);
+    }
+  }
+  strncpy(shownText[panelIndex], text, NUMERIC_FIELD_LEN - 1);
+  shownText[panelIndex][NUMERIC_FIELD_LEN - 1] = '\0';
+}
+
+// Specialized drawing functions for different data types, each into the panel's own
+// sprite; the compositor pushes it together with whatever overlaps it
+void drawRPMPanel(uint8_t panelIndex, TFT_eSprite &sprite, unsigned int value, uint16_t color, unsigned int lastValue, bool setup, bool stale) {
   if (lastValue != value || forceRefresh || setup || first_run) {
-    // Apply color logic based on isColorFull
-    uint16_t textColor = TFT_ORANGE;  // Default when isColorFull = false
-    if (isColorFull) {
-      if (value > 6000) {
-        textColor = TFT_RED;
-      } else if (value > 4000) {
-        textColor = TFT_YELLOW;
-      } else {
-        textColor = TFT_GREEN;
-      }
+    uint16_t textColor = color;
+    if (stale) {
+      textColor = STALE_VALUE_COLOR;
     }
     
-    spr.setFreeFont(AA_FONT_FREE_MEDIUM);
-    spr.createSprite(90, 40);
-    spr.fillSprite(TFT_BLACK);  // Clear sprite background
-    spr.setTextDatum(TR_DATUM);
-    spr_width = spr.textWidth("9999");
-    spr.setTextColor(textColor, TFT_BLACK, true);
-    spr.drawNumber(value, spr_width, 3);
-    spr.pushSprite(x, y + 35 - 15);
-    spr.deleteSprite();
+    if (isGlyphAtlasReady()) {
+      spr_width = getAtlasTextWidth("9999");
+    } else {
+      sprite.setFreeFont(AA_FONT_FREE_MEDIUM);
+      spr_width = sprite.textWidth("9999");
+    }
+    char text[22] = {0};
+    formatValue(text, value, 0);
+    drawNumericField(panelIndex, sprite, text, spr_width, 3, TR_DATUM, textColor, setup);
   }
 }
 
-void drawIntPanel(int x, int y, const char *label, int value, uint16_t color, int lastValue, bool setup) {
+void drawIntPanel(uint8_t panelIndex, TFT_eSprite &sprite, int value, uint16_t color, int lastValue, bool setup, bool stale) {
   if (lastValue != value || forceRefresh || setup || first_run) {
-    lablDraw(x, y, label, 0);
-    
-    // Apply color logic based on isColorFull and label
-    uint16_t textColor = TFT_ORANGE;  // Default when isColorFull = false
-    if (isColorFull) {
-      if (strcmp(label, "CLT") == 0) {
-        if (value > 110) {
-          textColor = TFT_RED;
-        } else if (value > 80) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "IAT") == 0) {
-        if (value > 60) {
-          textColor = TFT_RED;
-        } else if (value > 40) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "TPS") == 0) {
-        if (value > 100) {
-          textColor = TFT_RED;
-        } else if (value > 80) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "MAP") == 0) {
-        if (value > 100) {
-          textColor = TFT_RED;
-        } else if (value > 80) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "ADV") == 0) {
-        if (value < 0) {
-          textColor = TFT_RED;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "FP") == 0) {
-        if (value < 28) {
-          textColor = TFT_RED;
-        } else if (value < 30) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      }
+    uint16_t textColor = color;
+    if (stale) {
+      textColor = STALE_VALUE_COLOR;
     }
     
-    spr.setFreeFont(AA_FONT_FREE_MEDIUM);
-    
-    // Use smaller sprite width for panels at right edge (like ADV at x=256)
-    int spriteWidth = 64;  
-    spr.createSprite(spriteWidth, 38);
-    
-    spr.fillSprite(TFT_BLACK);  // Clear sprite background to prevent artifacts
-    spr.setTextDatum(TC_DATUM);
-    spr_width = spr.textWidth("9999");
-    spr.setTextColor(textColor, TFT_BLACK, true);
-    spr.drawNumber(value, spriteWidth/2, 3);
-    spr.pushSprite(x, y + 35 - 15);
-    spr.deleteSprite();
+    int spriteWidth = sprite.width();
+    char text[22] = {0};
+    formatValue(text, value, 0);
+    drawNumericField(panelIndex, sprite, text, spriteWidth/2, 3, TC_DATUM, textColor, setup);
   }
 }
 
-void drawFloatPanel(int x, int y, const char *label, float value, uint16_t color, float lastValue, int decimals, bool setup) {
+// `value` is fixed-point with `decimals` decimals
+void drawFloatPanel(uint8_t panelIndex, TFT_eSprite &sprite, int32_t value, uint16_t color, int32_t lastValue, int decimals, bool setup, bool stale) {
   if (lastValue != value || forceRefresh || setup || first_run) {
-    lablDraw(x, y, label, 1);
-    
-    // Apply color logic based on isColorFull and label
-    uint16_t textColor = TFT_ORANGE;  // Default when isColorFull = false
-    if (isColorFull) {
-      if (strcmp(label, "AFR") == 0) {
-        if ((value > 15.2) && (value < 20)) {
-          textColor = TFT_RED;
-        } else if (value < 13) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "BAT") == 0) {
-        if (value < 12.0) {
-          textColor = TFT_RED;
-        } else if (value < 12.5) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      }
+    uint16_t textColor = color;
+    if (stale) {
+      textColor = STALE_VALUE_COLOR;
     }
     
-    spr.setFreeFont(AA_FONT_FREE_MEDIUM);
-    spr.createSprite(70, 38);
-    spr.fillSprite(TFT_BLACK);  // Clear sprite background to prevent artifacts
-    spr.setTextDatum(TC_DATUM);
-    spr_width = spr.textWidth("99.9");
-    spr.setTextColor(textColor, TFT_BLACK, true);
-    spr.drawFloat(value, decimals, 35, 5);  // This will correctly display 0.0
-    spr.pushSprite(x, y + 35 - 15);
-    spr.deleteSprite();
+    char text[22] = {0};
+    formatValue(text, value, decimals);  // Integer formatting, no float on the render path
+    drawNumericField(panelIndex, sprite, text, 35, 5, TC_DATUM, textColor, setup);
+  }
+}
+
+// Time one value redraw of a 90x40 panel through the font path and through the
+// glyph atlas. Serial command 'b'; allocates its own sprite, so not during a drive.
+// Runs in the render task between frames: the atlas color slots have one user.
+static void benchmarkPanelRedraw() {
+  const int iterations = 200;
+  TFT_eSprite bench = TFT_eSprite(&display);
+  bench.setColorDepth(16);
+  if (!bench.createSprite(90, 40)) {
+    Serial.println("[BENCH] No memory for the benchmark sprite");
+    return;
+  }
+  char text[22];
+  uint16_t color = getSeverityColor(SEVERITY_NORMAL);
+  
+  uint32_t start = micros();
+  for (int i = 0; i < iterations; i++) {
+    bench.fillSprite(TFT_BLACK);
+    bench.setFreeFont(AA_FONT_FREE_MEDIUM);
+    bench.setTextDatum(TR_DATUM);
+    bench.setTextColor(color, TFT_BLACK, true);
+    bench.drawNumber(3000 + i, 72, 3);
   }
+  uint32_t fontUs = micros() - start;
+  
+  start = micros();
+  for (int i = 0; i < iterations; i++) {
+    bench.fillSprite(TFT_BLACK);
+    formatValue(text, 3000 + i, 0);
+    drawAtlasString(bench, text, 72, 3, TR_DATUM, color);
+  }
+  uint32_t atlasUs = micros() - start;
+  
+  // Steady driving: one digit changes per redraw
+  AtlasCellRect cells[NUMERIC_FIELD_LEN];
+  char previous[22] = {0};
+  formatValue(previous, 3450, 0);
+  uint32_t diffBytes = 0;
+  start = micros();
+  for (int i = 0; i < iterations; i++) {
+    formatValue(text, (i & 1) ? 3450 : 3460, 0);
+    int8_t changed = drawAtlasStringDiff(bench, text, previous, 72, 3, TR_DATUM, color, cells, NUMERIC_FIELD_LEN);
+    for (int8_t c = 0; c < changed; c++) {
+      diffBytes += cells[c].w * cells[c].h * 2;
+    }
+    strncpy(previous, text, sizeof(previous) - 1);
+  }
+  uint32_t diffUs = micros() - start;
+  bench.deleteSprite();
+  
+  Serial.println("=== PANEL REDRAW BENCHMARK ===");
+  Serial.printf("Font path:   %.1f us per redraw\n", (float)fontUs / iterations);
+  if (isGlyphAtlasReady()) {
+    Serial.printf("Glyph atlas: %.1f us per redraw\n", (float)atlasUs / iterations);
+    Serial.printf("Digit diff:  %.1f us, %u bytes pushed per redraw (whole sprite %u)\n",
+                  (float)diffUs / iterations, diffBytes / iterations, 90 * 40 * 2);
+  } else {
+    Serial.println("Glyph atlas: not built");
+  }
+  Serial.println("==============================");
 }
 
 // Keep legacy function for compatibility
@@ -284,8 +560,8 @@ void drawConfigurableIndicators() {
   int currentPosition = 0;
   int maxIndicators = 6;  // Maximum 6 indicators to fit in display width
   
-  for (int i = 0; i < currentDisplayConfig.activeIndicatorCount && currentPosition < maxIndicators; i++) {
-    IndicatorConfig &indicator = currentDisplayConfig.indicators[i];
+  for (int i = 0; i < renderLayout.indicatorCount && currentPosition < maxIndicators; i++) {
+    const IndicatorConfig &indicator = renderLayout.indicators[i];
     
     if (indicator.enabled) {  // Only process enabled indicators
       bool state = getIndicatorValue(indicator.indicator);
@@ -382,22 +658,31 @@ void drawConfigurableData(bool setup) {
     defaultLayoutInitialized = true;
   }
   
-  // Draw configurable panels with optimized frequency
-  static uint32_t lastPanelUpdate = 0;
-  if (setup || (millis() - lastPanelUpdate > 50)) { // Update panels every 50ms max
-    drawConfigurablePanels(setup);
-    lastPanelUpdate = millis();
+  // Panel sprites are (re)sized here, never inside a steady-state frame
+  if (setup) {
+    requestPanelLayout();   // Nothing else runs yet, take the layout as it is
+  }
+  if (panelLayoutPending) {
+    applyPendingLayout();
+    allocatePanelSprites();
   }
   
-  // Draw configurable indicators with optimized frequency  
-  static uint32_t lastIndicatorUpdate = 0;
-  if (setup || (millis() - lastIndicatorUpdate > 100)) { // Update indicators every 100ms max
+  // Pacing comes from the render task: panels are drawn every frame
+  drawConfigurablePanels(setup);
+  
+  // Indicators are low priority: when the panels ate most of the frame budget they
+  // wait for the next frame, up to RENDER_MAX_DEFER_FRAMES in a row
+  static uint8_t indicatorDefers = 0;
+  if (!setup && indicatorDefers < RENDER_MAX_DEFER_FRAMES && shouldDeferLowPriority()) {
+    indicatorDefers++;
+  } else {
     drawConfigurableIndicators();
-    lastIndicatorUpdate = millis();
+    indicatorDefers = 0;
   }
 }
 
 void startUpDisplay() {
+  latchTelemetry();
   display.fillScreen(TFT_BLACK);
   spr.setColorDepth(16);
   
@@ -408,166 +693,6 @@ void startUpDisplay() {
   first_run = false;
 }
 
-void lablDraw(int x, int y, const char *label, int type) {
-  if (first_run || forceRefresh) {
-    uint16_t textColor = TFT_CYAN;
-
-    if (isColorFull) {
-      textColor = TFT_WHITE;
-    }
-    if (type == 0) {
-      spr.setFreeFont(AA_FONT_FREE_SMALL);
-      spr.createSprite(50, 70);
-      spr.setTextColor(textColor, TFT_BLACK, true);
-      spr.setTextDatum(TC_DATUM);
-      spr.drawString(label, 15, 5);
-      spr.pushSprite(x + 10, y);
-      spr.deleteSprite();
-    } else {
-      spr.setFreeFont(AA_FONT_FREE_SMALL);
-      spr.createSprite(50, 70);
-      spr.setTextDatum(TC_DATUM);
-      spr.setTextColor(textColor, TFT_BLACK, true);
-      spr.drawString(label, 15, 5);
-      spr.pushSprite(x + 10, y);
-      spr.deleteSprite();
-    }
-  }
-}
-
-void itemDrawDataUsignedInt(unsigned int value, unsigned int &lastValue, int x, int y, const char *label) {
-  lablDraw(x, y, label, 0);
-
-  if (lastValue != value || forceRefresh) {
-    uint16_t textColor = TFT_ORANGE;
-    if (isColorFull) {
-      if (strcmp(label, "RPM") == 0) {
-        if (value > 6000) {
-          textColor = TFT_RED;
-        } else if (value > 4000) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      }
-    }
-
-    spr.setFreeFont(AA_FONT_FREE_MEDIUM);
-    spr.createSprite(90, 40);
-    spr.setTextDatum(TR_DATUM);
-    spr_width = spr.textWidth("9999");
-    spr.setTextColor(textColor, TFT_BLACK, true);
-    spr.drawNumber(value, 90, 5);
-    spr.pushSprite(x - 10, y + 35 - 15);
-    spr.deleteSprite();
-    lastValue = value;
-  }
-}
-
-void itemDrawDataInt(int value, int &lastValue, int x, int y, const char *label) {
-  if (lastValue != value || forceRefresh) {
-    uint16_t textColor = TFT_ORANGE;
-    if (isColorFull) {
-      if (strcmp(label, "CLT") == 0) {
-        if (value > 110) {
-          textColor = TFT_RED;
-        } else if (value > 80) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "IAT") == 0) {
-        if (value > 60) {
-          textColor = TFT_RED;
-        } else if (value > 40) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "TPS") == 0) {
-        if (value > 100) {
-          textColor = TFT_RED;
-        } else if (value > 80) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "MAP") == 0) {
-        if (value > 100) {
-          textColor = TFT_RED;
-        } else if (value > 80) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "ADV") == 0) {
-        if (value < 0) {
-          textColor = TFT_RED;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "FP") == 0) {
-        if (value < 28) {
-          textColor = TFT_RED;
-        } else if (value < 30) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      }
-    }
-    lablDraw(x, y, label, 0);
-    spr.setFreeFont(AA_FONT_FREE_MEDIUM);
-    spr.createSprite(50, 38);
-    spr.setTextDatum(TC_DATUM);
-    spr_width = spr.textWidth("0");
-    spr.setTextColor(textColor, TFT_BLACK, true);
-    spr.drawNumber(value, 30, 3);
-    if (strcmp(label, "ADV") == 0) {
-      spr.pushSprite(x, y + 35 - 15);
-    } else {
-      spr.pushSprite(x, y + 35 - 15);
-    }
-    spr.deleteSprite();
-    lastValue = value;
-  }
-}
-
-void itemDrawDataFloat(float value, float &lastValue, int x, int y, const char *label) {
-  if (lastValue != value || forceRefresh) {
-    uint16_t textColor = TFT_ORANGE;
-    if (isColorFull) {
-      if (strcmp(label, "AFR") == 0) {
-        if ((value > 15.2) && (value < 20)) {
-          textColor = TFT_RED;
-        } else if (value < 13) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      } else if (strcmp(label, "BAT") == 0) {
-        if (value < 12.0) {
-          textColor = TFT_RED;
-        } else if (value < 12.5) {
-          textColor = TFT_YELLOW;
-        } else {
-          textColor = TFT_GREEN;
-        }
-      }
-    }
-    lablDraw(x, y, label, 1);
-    spr.setFreeFont(AA_FONT_FREE_MEDIUM);
-    spr.createSprite(70, 38);
-    spr.setTextDatum(TC_DATUM);
-    spr_width = spr.textWidth("99.9");
-    spr.setTextColor(textColor, TFT_BLACK, true);
-    spr.drawFloat(value, 1, 30, 5);
-    spr.pushSprite(x, y + 35 - 15);
-    spr.deleteSprite();
-    lastValue = value;
-  }
-}
-
 void itemDraw(bool setup) {
   // Use dynamic configurable panel system instead of hardcoded layout
   drawConfigurableData(setup);
@@ -614,7 +739,44 @@ void drawDataBox(int x, int y, const char *label, const float value, uint16_t la
 }
 
 void drawData() {
+  // One consistent snapshot for every panel drawn this frame
+  latchTelemetry();
+
+  // Entering or leaving peak recall repaints every panel and the PEAK tag
+  static bool lastRecall = false;
+  bool recall = isPeakRecallActive();
+  if (recall != lastRecall) {
+    forceRefresh = true;
+    markWidgetDirty(peakWidget);
+    lastRecall = recall;
+  }
+
+#if ENABLE_SIMULATOR
+  // Simulator indicator is a compositor widget: repaint it only when the mode changes
+  static uint8_t lastSimMode = SIMULATOR_MODE_OFF;
+  uint8_t currentSimMode = getSimulatorMode();
+  if (currentSimMode != lastSimMode) {
+    markWidgetDirty(simWidget);
+    lastSimMode = currentSimMode;
+  }
+#endif
+
+#if ENABLE_DEBUG_MODE
+  if (debugMode) {
+    // Create debug info string - show only essential info in one line
+    String debugInfo = "CPU:" + String(cpuUsage, 1) + "% FPS:" + String(fps, 1) + " Heap:" + String(ESP.getFreeHeap()/1024) + "K";
+    if (debugInfo != debugOverlayText) {
+      debugOverlayText = debugInfo;
+      markWidgetDirty(debugWidget);
+    }
+  } else if (debugOverlayText.length() > 0) {
+    // Clear debug area when debug mode is turned off
+    debugOverlayText = "";
+    markWidgetDirty(debugWidget);
+  }
+#endif
 
+  // Overlays above were only marked dirty; they are pushed with the panels they overlap
   itemDraw(false);
   
   // Reset forceRefresh after first update
@@ -622,33 +784,11 @@ void drawData() {
     forceRefresh = false;
     Serial.println("[DISPLAY] Force refresh completed");
   }
-  
-#if ENABLE_SIMULATOR
-  // Draw simulator indicator if simulator is active (with reduced update frequency)
-  static uint8_t lastSimMode = SIMULATOR_MODE_OFF;
-  static uint32_t lastSimUpdate = 0;
-  uint8_t currentSimMode = getSimulatorMode();
-  
-  // Only redraw if simulator mode has changed or every 500ms
-  if (currentSimMode != lastSimMode || (millis() - lastSimUpdate > 500)) {
-    if (currentSimMode != SIMULATOR_MODE_OFF) {
-      // Clear the SIM area first
-      display.fillRect(display.width() - 30, 5, 25, 15, TFT_BLACK);
-      
-      // Draw SIM indicator
-      display.setFreeFont(AA_FONT_FREE_SMALL);
-      display.setTextColor(TFT_YELLOW, TFT_BLACK);
-      display.setTextDatum(TR_DATUM);
-      display.drawString("SIM", display.width() - 5, 5);
-    } else {
-      // Clear the SIM indicator when simulator is turned off
-      display.fillRect(display.width() - 30, 5, 25, 15, TFT_BLACK);
-    }
-    
-    lastSimMode = currentSimMode;
-    lastSimUpdate = millis();
+
+  if (benchmarkPending) {
+    benchmarkPending = false;
+    benchmarkPanelRedraw();
   }
-#endif
 
   // // Draw communication mode indicator (top left) with reduced update frequency
   // static bool lastCommMode = true;  // Track changes
@@ -672,39 +812,4 @@ void drawData() {
   //   lastCommText = currentCommText;
   //   lastCommUpdate = millis();
   // }
-
-#if ENABLE_DEBUG_MODE
-  static bool lastDebugMode = false;
-  static String lastDebugInfo = "";
-  
-  if (debugMode) {
-    // Create debug info string - show only essential info in one line
-    String debugInfo = "CPU:" + String(cpuUsage, 1) + "% FPS:" + String(fps, 1) + " Heap:" + String(ESP.getFreeHeap()/1024) + "K";
-    
-    if (debugInfo != lastDebugInfo || !lastDebugMode) {
-      int centerX = display.width() / 2;
-      
-      // Clear the debug area first to prevent font overlap
-      display.fillRect(centerX - 120, 5, 240, 20, TFT_BLACK);
-      
-      // Draw debug info
-      display.setFreeFont(AA_FONT_FREE_SMALL);
-      display.setTextColor(TFT_CYAN, TFT_BLACK);
-      display.setTextDatum(TC_DATUM);
-      display.drawString(debugInfo, centerX, 5);
-      
-      lastDebugInfo = debugInfo;
-    }
-    
-    lastDebugMode = true;
-  } else {
-    // Clear debug area when debug mode is turned off
-    if (lastDebugMode) {
-      // Clear the top center area where debug info was displayed
-      display.fillRect(0, 5, display.width(), 20, TFT_BLACK);
-      lastDebugMode = false;
-      lastDebugInfo = "";
-    }
-  }
-#endif
 }
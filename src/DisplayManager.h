@@ -18,5 +18,10 @@ void drawConfigurableData(bool setup);
 void drawConfigurablePanels(bool setup);
 void drawConfigurableIndicators();
 void drawModularDataPanel(const DisplayPanel &panel, bool setup);
+void requestPanelLayout();
+uint32_t getRenderSpriteAllocations();
+uint32_t getLayoutSpriteAllocations();
+uint32_t getPanelSpriteBytes();
+void requestPanelRedrawBenchmark();
 
 #endif // DISPLAY_MANAGER_H
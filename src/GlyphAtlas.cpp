@@ -0,0 +1,259 @@
+#include "GlyphAtlas.h"
+
+extern TFT_eSPI display;
+
+// One strip holding every atlas glyph side by side, each cell as wide as the
+// glyph's advance. Rows are cropped to the band that has ink in any glyph.
+static const char atlasChars[] = GLYPH_ATLAS_CHARS;
+static const uint8_t atlasCharCount = sizeof(atlasChars) - 1;
+static int16_t cellX[atlasCharCount];
+static int16_t cellW[atlasCharCount];      // xAdvance
+static int16_t lastGlyphW[atlasCharCount]; // xOffset + width, what textWidth() counts for the final glyph
+static int16_t stripW = 0;
+static int16_t inkTop = 0;    // First ink row below the top-datum y
+static int16_t inkH = 0;
+
+// Coverage mask built once from the font, then expanded into RGB565 per color
+static uint8_t *mask = nullptr;
+
+// Colors in use at the same time are few (theme, warn, critical, recall, stale);
+// the least recently used slot is refilled from the mask when a new one shows up
+struct AtlasColorSlot {
+  uint16_t color;
+  uint32_t lastUsed;
+  uint16_t *pixels;   // stripW x inkH, sprite byte order
+};
+static AtlasColorSlot slots[GLYPH_ATLAS_COLOR_SLOTS];
+static uint32_t useCounter = 0;
+static uint32_t atlasBytes = 0;
+
+static int8_t findGlyph(char c) {
+  for (uint8_t i = 0; i < atlasCharCount; i++) {
+    if (atlasChars[i] == c) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Rasterize every glyph once through the normal font path so the atlas matches it pixel for pixel
+bool initGlyphAtlas(const GFXfont *font, uint32_t &allocations) {
+  if (mask) {
+    return true;
+  }
+  TFT_eSprite build = TFT_eSprite(&display);
+  build.setColorDepth(16);
+  build.setFreeFont(font);
+  char glyph[2] = {0, 0};
+  stripW = 0;
+  for (uint8_t i = 0; i < atlasCharCount; i++) {
+    uint8_t c = atlasChars[i];
+    if (c < font->first || c > font->last) {
+      return false;
+    }
+    // textWidth() of a single character is its ink extent, not its advance
+    const GFXglyph &g = font->glyph[c - font->first];
+    cellX[i] = stripW;
+    cellW[i] = g.xAdvance;
+    lastGlyphW[i] = (int8_t)g.xOffset + g.width;
+    stripW += cellW[i];
+  }
+  int16_t buildH = build.fontHeight();
+  if (stripW <= 0 || buildH <= 0 || !build.createSprite(stripW, buildH)) {
+    return false;
+  }
+  build.fillSprite(TFT_BLACK);
+  build.setTextColor(TFT_WHITE, TFT_BLACK, true);
+  build.setTextDatum(TL_DATUM);
+  for (uint8_t i = 0; i < atlasCharCount; i++) {
+    glyph[0] = atlasChars[i];
+    build.drawString(glyph, cellX[i], 0);
+  }
+
+  // Crop to the rows any glyph touches
+  int16_t first = buildH, last = -1;
+  for (int16_t y = 0; y < buildH; y++) {
+    for (int16_t x = 0; x < stripW; x++) {
+      if (build.readPixel(x, y) != TFT_BLACK) {
+        first = min(first, y);
+        last = y;
+        break;
+      }
+    }
+  }
+  if (last < first) {
+    build.deleteSprite();
+    return false;
+  }
+  inkTop = first;
+  inkH = last - first + 1;
+
+  allocations++;
+  mask = (uint8_t *)malloc(stripW * inkH);
+  if (!mask) {
+    build.deleteSprite();
+    return false;
+  }
+  for (int16_t y = 0; y < inkH; y++) {
+    for (int16_t x = 0; x < stripW; x++) {
+      mask[y * stripW + x] = build.readPixel(x, inkTop + y) != TFT_BLACK;
+    }
+  }
+  build.deleteSprite();
+  atlasBytes = stripW * inkH;
+
+  for (uint8_t i = 0; i < GLYPH_ATLAS_COLOR_SLOTS; i++) {
+    allocations++;
+    slots[i].pixels = (uint16_t *)malloc(stripW * inkH * sizeof(uint16_t));
+    slots[i].lastUsed = 0;
+    slots[i].color = 0;
+    if (slots[i].pixels) {
+      atlasBytes += stripW * inkH * sizeof(uint16_t);
+    }
+  }
+  Serial.printf("[DISPLAY] Glyph atlas: %d glyphs, %dx%d strip, %u bytes\n", atlasCharCount, stripW, inkH, atlasBytes);
+  return true;
+}
+
+bool isGlyphAtlasReady() {
+  return mask != nullptr;
+}
+
+uint32_t getGlyphAtlasBytes() {
+  return atlasBytes;
+}
+
+// Slot holding `color`, refilling the least recently used one on a miss
+static const uint16_t *getColorPixels(uint16_t color) {
+  AtlasColorSlot *victim = nullptr;
+  for (uint8_t i = 0; i < GLYPH_ATLAS_COLOR_SLOTS; i++) {
+    AtlasColorSlot &slot = slots[i];
+    if (!slot.pixels) {
+      continue;
+    }
+    if (slot.lastUsed && slot.color == color) {
+      slot.lastUsed = ++useCounter;
+      return slot.pixels;
+    }
+    if (!victim || slot.lastUsed < victim->lastUsed) {
+      victim = &slot;
+    }
+  }
+  if (!victim) {
+    return nullptr;
+  }
+  uint16_t ink = (color >> 8) | (color << 8);   // Sprites keep 16-bit pixels byte swapped
+  uint32_t count = (uint32_t)stripW * inkH;
+  for (uint32_t i = 0; i < count; i++) {
+    victim->pixels[i] = mask[i] ? ink : TFT_BLACK;
+  }
+  victim->color = color;
+  victim->lastUsed = ++useCounter;
+  return victim->pixels;
+}
+
+// Width as the font path would measure it, or -1 if a character isn't in the atlas.
+// Like textWidth(): advances for every glyph but the last, which counts its ink.
+int16_t getAtlasTextWidth(const char *text) {
+  int16_t width = 0;
+  for (const char *c = text; *c; c++) {
+    int8_t g = findGlyph(*c);
+    if (g < 0) {
+      return -1;
+    }
+    width += c[1] ? cellW[g] : lastGlyphW[g];
+  }
+  return width;
+}
+
+// Copy one glyph cell into a 16-bit sprite buffer, clipped to the sprite;
+// returns the sprite-space rect written (w = 0 if nothing was)
+static AtlasCellRect blitCell(uint16_t *dst, int16_t spriteW, int16_t spriteH, int8_t g, int32_t x, int32_t y, const uint16_t *src) {
+  AtlasCellRect rect = {0, 0, 0, 0};
+  int32_t left = max((int32_t)0, x);
+  int32_t right = min((int32_t)spriteW, x + cellW[g]);
+  int32_t top = max((int32_t)0, y + inkTop);
+  int32_t bottom = min((int32_t)spriteH, y + inkTop + inkH);
+  if (right <= left || bottom <= top) {
+    return rect;
+  }
+  for (int32_t row = top; row < bottom; row++) {
+    memcpy(dst + row * spriteW + left,
+           src + (row - y - inkTop) * stripW + cellX[g] + (left - x),
+           (right - left) * sizeof(uint16_t));
+  }
+  rect = {(int16_t)left, (int16_t)top, (int16_t)(right - left), (int16_t)(bottom - top)};
+  return rect;
+}
+
+// Left edge of text placed at x with the given datum, or false for datums the atlas doesn't do
+static bool alignText(int32_t &x, int16_t width, uint8_t datum) {
+  if (datum == TC_DATUM) {
+    x -= width / 2;
+  } else if (datum == TR_DATUM) {
+    x -= width;
+  } else if (datum != TL_DATUM) {
+    return false;
+  }
+  return true;
+}
+
+// Copy the glyph cells row by row into a 16-bit sprite. Same placement as
+// drawString() for TL/TC/TR datums; black background like the value fields.
+// Returns false if the text can't be drawn from the atlas.
+bool drawAtlasString(TFT_eSprite &sprite, const char *text, int32_t x, int32_t y, uint8_t datum, uint16_t color) {
+  uint16_t *dst = mask ? (uint16_t *)sprite.getPointer() : nullptr;
+  int16_t width = getAtlasTextWidth(text);
+  if (!dst || width < 0 || !alignText(x, width, datum)) {
+    return false;
+  }
+  const uint16_t *src = getColorPixels(color);
+  if (!src) {
+    return false;
+  }
+  for (const char *c = text; *c; c++) {
+    int8_t g = findGlyph(*c);
+    blitCell(dst, sprite.width(), sprite.height(), g, x, y, src);
+    x += cellW[g];
+  }
+  return true;
+}
+
+// Redraw only the glyph cells where `text` differs from `previous`, which must have
+// been drawn at the same place and color. Changed cells go to `changed` in sprite
+// coordinates. Returns how many, or -1 when the layout differs (length, a glyph of
+// another width, text outside the atlas) and the caller has to redraw everything.
+int8_t drawAtlasStringDiff(TFT_eSprite &sprite, const char *text, const char *previous, int32_t x, int32_t y,
+                           uint8_t datum, uint16_t color, AtlasCellRect *changed, uint8_t maxChanged) {
+  uint16_t *dst = mask ? (uint16_t *)sprite.getPointer() : nullptr;
+  size_t len = strlen(text);
+  if (!dst || len != strlen(previous) || len > maxChanged) {
+    return -1;
+  }
+  for (size_t i = 0; i < len; i++) {
+    int8_t g = findGlyph(text[i]);
+    int8_t p = findGlyph(previous[i]);
+    if (g < 0 || p < 0 || cellW[g] != cellW[p]) {
+      return -1;
+    }
+  }
+  if (!alignText(x, getAtlasTextWidth(text), datum)) {
+    return -1;
+  }
+  const uint16_t *src = getColorPixels(color);
+  if (!src) {
+    return -1;
+  }
+  int8_t count = 0;
+  for (size_t i = 0; i < len; i++) {
+    int8_t g = findGlyph(text[i]);
+    if (text[i] != previous[i]) {
+      AtlasCellRect rect = blitCell(dst, sprite.width(), sprite.height(), g, x, y, src);
+      if (rect.w > 0) {
+        changed[count++] = rect;
+      }
+    }
+    x += cellW[g];
+  }
+  return count;
+}
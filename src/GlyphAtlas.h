@@ -0,0 +1,25 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <stdint.h>
+#include <TFT_eSPI.h>
+#include "Config.h"
+
+// Value fields only ever show these; everything else goes through the font path
+#define GLYPH_ATLAS_CHARS " -.0123456789"
+
+// Sprite-space area one glyph cell was drawn to
+struct AtlasCellRect {
+  int16_t x, y, w, h;
+};
+
+// Function declarations
+bool initGlyphAtlas(const GFXfont *font, uint32_t &allocations);
+bool isGlyphAtlasReady();
+int16_t getAtlasTextWidth(const char *text);
+bool drawAtlasString(TFT_eSprite &sprite, const char *text, int32_t x, int32_t y, uint8_t datum, uint16_t color);
+int8_t drawAtlasStringDiff(TFT_eSprite &sprite, const char *text, const char *previous, int32_t x, int32_t y,
+                           uint8_t datum, uint16_t color, AtlasCellRect *changed, uint8_t maxChanged);
+uint32_t getGlyphAtlasBytes();
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,107 @@
+#include "RenderTask.h"
+#include "DataTypes.h"
+#include "DisplayManager.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const uint32_t frameBudgetUs = 1000000UL / RENDER_TARGET_FPS;
+
+// Ring of recent frame work times; percentiles are computed on request
+static uint32_t frameTimes[RENDER_FRAME_SAMPLES];
+static uint16_t frameTimeHead = 0;
+static uint16_t frameTimeCount = 0;
+static volatile uint32_t overruns = 0;
+static volatile uint32_t deferredWidgets = 0;
+static volatile uint32_t totalFrames = 0;
+static portMUX_TYPE frameTimesMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Start of the frame being drawn; 0 outside the render task (setup, first frame)
+static volatile uint32_t frameStartUs = 0;
+
+static void recordFrameTime(uint32_t us) {
+  portENTER_CRITICAL(&frameTimesMux);
+  frameTimes[frameTimeHead] = us;
+  frameTimeHead = (frameTimeHead + 1) % RENDER_FRAME_SAMPLES;
+  if (frameTimeCount < RENDER_FRAME_SAMPLES) {
+    frameTimeCount++;
+  }
+  portEXIT_CRITICAL(&frameTimesMux);
+  totalFrames++;
+  if (us > frameBudgetUs) {
+    overruns++;
+  }
+}
+
+// Paced by absolute deadlines: a slow frame shortens the next sleep instead of
+// pushing every later frame back
+static void renderTask(void *pvParameters) {
+  const TickType_t period = pdMS_TO_TICKS(1000 / RENDER_TARGET_FPS);
+  TickType_t lastWake = xTaskGetTickCount();
+  while (1) {
+    frameStartUs = micros();
+    drawData();
+    uint32_t workUs = micros() - frameStartUs;
+    frameStartUs = 0;
+    recordFrameTime(workUs);
+    frameCount++;   // Feeds the debug FPS counter
+    vTaskDelayUntil(&lastWake, period);
+  }
+}
+
+// Display loop leaves Arduino loop(): it runs on core 1 above loop()'s priority so
+// web and serial handling can't stretch a frame
+void startRenderTask() {
+  xTaskCreatePinnedToCore(renderTask, "Render Task", RENDER_TASK_STACK, NULL, 2, NULL, 1);
+  Serial.printf("[DISPLAY] Render task started: %d fps target, %u us budget\n", RENDER_TARGET_FPS, frameBudgetUs);
+}
+
+// True when the frame has used enough of its budget that optional widgets should wait
+bool shouldDeferLowPriority() {
+  uint32_t start = frameStartUs;
+  if (start == 0) {
+    return false;
+  }
+  if (micros() - start < frameBudgetUs * RENDER_LOW_PRIORITY_PCT / 100) {
+    return false;
+  }
+  deferredWidgets++;
+  return true;
+}
+
+void getFrameTimeStats(FrameTimeStats &out) {
+  static uint32_t sorted[RENDER_FRAME_SAMPLES];
+  uint16_t count;
+  portENTER_CRITICAL(&frameTimesMux);
+  count = frameTimeCount;
+  memcpy(sorted, frameTimes, count * sizeof(uint32_t));
+  portEXIT_CRITICAL(&frameTimesMux);
+
+  // Insertion sort: 128 samples, only when someone asks
+  for (uint16_t i = 1; i < count; i++) {
+    uint32_t v = sorted[i];
+    int16_t j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+
+  out.p50Us = count ? sorted[(count - 1) * 50 / 100] : 0;
+  out.p95Us = count ? sorted[(count - 1) * 95 / 100] : 0;
+  out.p99Us = count ? sorted[(count - 1) * 99 / 100] : 0;
+  out.maxUs = count ? sorted[count - 1] : 0;
+  out.budgetUs = frameBudgetUs;
+  out.overruns = overruns;
+  out.deferredWidgets = deferredWidgets;
+  out.frames = totalFrames;
+}
+
+void printFrameTimeStats() {
+  FrameTimeStats stats;
+  getFrameTimeStats(stats);
+  Serial.printf("Frame Time: p50 %uus, p95 %uus, p99 %uus, max %uus (budget %uus)\n",
+                stats.p50Us, stats.p95Us, stats.p99Us, stats.maxUs, stats.budgetUs);
+  Serial.printf("Frame Overruns: %u of %u, deferred widgets: %u\n",
+                stats.overruns, stats.frames, stats.deferredWidgets);
+}
@@ -0,0 +1,26 @@
+#ifndef RENDER_TASK_H
+#define RENDER_TASK_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Config.h"
+
+// Frame-time distribution over the last RENDER_FRAME_SAMPLES frames
+struct FrameTimeStats {
+  uint32_t p50Us;
+  uint32_t p95Us;
+  uint32_t p99Us;
+  uint32_t maxUs;
+  uint32_t budgetUs;
+  uint32_t overruns;        // Frames whose work took longer than the budget
+  uint32_t deferredWidgets; // Low-priority widget draws pushed to a later frame
+  uint32_t frames;
+};
+
+// Function declarations
+void startRenderTask();
+bool shouldDeferLowPriority();
+void getFrameTimeStats(FrameTimeStats &out);
+void printFrameTimeStats();
+
+#endif // RENDER_TASK_H
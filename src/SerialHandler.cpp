@@ -2,74 +2,250 @@
 #include "Config.h"
 #include "DataTypes.h"
 #include "Comms.h"
+#include "Telemetry.h"
+#include "SerialRangePlanner.h"
+#include "SerialStats.h"
+#include "DerivedChannels.h"
+#include "DisplayConfig.h"
+#include "SessionPeaks.h"
 #include "GlobalVariables.h"
+#include "Simulator.h"
 #include "Arduino.h"
 
+static TaskHandle_t serialTaskHandle = NULL;
+static SerialRangePlan rangePlan = {0, 0, {}, 0};
+static uint8_t rangeIndex = 0;
+static bool useRangeReads = true;       // Cleared if the ECU answers 'n' but never 'r'
+static bool rangeReadsConfirmed = false;
+static bool probingFullPoll = false;    // Current poll is an 'n' sent to tell old firmware from no ECU
+static uint8_t rangeFailures = 0;
+
+// Values the current layout shows, plus what runs without a panel: session peaks,
+// channels with an alarm rule, and RPM for the RPM bar
+static uint32_t getSerialLayoutMask() {
+  uint32_t mask = SERIAL_SOURCE_BIT(DATA_SOURCE_RPM) | PEAK_SESSION_CHANNELS;  // Same bit layout
+  for (uint8_t i = 0; i < DATA_SOURCE_COUNT; i++) {
+    if (!(currentDisplayConfig.alarms[i].flags & ALARM_FLAG_MASK)) {
+      continue;
+    }
+    mask |= (i < DATA_SOURCE_DERIVED_1) ? SERIAL_SOURCE_BIT(i) : getDerivedInputMask(i);
+  }
+  for (int i = 0; i < currentDisplayConfig.activePanelCount; i++) {
+    const DisplayPanel &panel = currentDisplayConfig.panels[i];
+    if (panel.enabled && panel.dataSource < DATA_SOURCE_DERIVED_1) {
+      mask |= SERIAL_SOURCE_BIT(panel.dataSource);
+    } else if (panel.enabled && panel.dataSource < DATA_SOURCE_COUNT) {
+      mask |= getDerivedInputMask(panel.dataSource);  // Same bit layout as SERIAL_SOURCE_BIT
+    }
+  }
+  for (int i = 0; i < currentDisplayConfig.activeIndicatorCount; i++) {
+    const IndicatorConfig &indicator = currentDisplayConfig.indicators[i];
+    if (indicator.enabled && indicator.indicator < INDICATOR_COUNT) {
+      mask |= SERIAL_INDICATOR_BIT(indicator.indicator);
+    }
+  }
+  return mask;
+}
+
+// Start a poll: one 'r' per planned range, or a full 'n' on old firmware
+static void startPollCycle() {
+  if (!useRangeReads || probingFullPoll) {
+    sendDataRequest();
+    return;
+  }
+
+  // Replan whenever the layout asks for a different set of values
+  uint32_t mask = getSerialLayoutMask();
+  if (mask != rangePlan.sourceMask) {
+    planSerialRanges(mask, rangePlan);
+    Serial.printf("[SERIAL] Range plan: %u reads, %u bytes per poll:", rangePlan.rangeCount, rangePlan.totalBytes);
+    for (uint8_t i = 0; i < rangePlan.rangeCount; i++) {
+      Serial.printf(" %u+%u", rangePlan.ranges[i].offset, rangePlan.ranges[i].length);
+    }
+    Serial.println();
+  }
+
+  rangeIndex = 0;
+  sendRangeRequest(rangePlan.ranges[0].offset, rangePlan.ranges[0].length);
+}
+
+// Returns true once every read of the cycle has completed
+static bool advancePollCycle() {
+  if (probingFullPoll) {
+    // 'n' works where 'r' never did: firmware predates range reads
+    probingFullPoll = false;
+    useRangeReads = false;
+    Serial.println("[SERIAL] ECU does not answer 'r' range reads, falling back to full 'n' polls");
+    return true;
+  }
+  if (!useRangeReads) {
+    return true;
+  }
+  rangeReadsConfirmed = true;
+  rangeIndex++;
+  if (rangeIndex < rangePlan.rangeCount) {
+    sendRangeRequest(rangePlan.ranges[rangeIndex].offset, rangePlan.ranges[rangeIndex].length);
+    return false;
+  }
+  return true;
+}
+
+// A silent ECU fails both commands, so after a run of failed 'r' polls one 'n'
+// is tried before deciding the firmware lacks range reads
+static void failPollCycle() {
+  if (probingFullPoll) {
+    probingFullPoll = false;
+    rangeFailures = 0;
+    return;
+  }
+  // The framed protocol was already proven to answer 'r' during the link probe
+  if (useRangeReads && !rangeReadsConfirmed && !isSerialFramed() && ++rangeFailures >= SERIAL_RANGE_FAILURE_LIMIT) {
+    probingFullPoll = true;
+  }
+}
+
+// Runs in the UART driver's event task when the RX FIFO fills or the line goes idle
+static void onSerialReceive() {
+  if (serialTaskHandle != NULL) {
+    xTaskNotifyGive(serialTaskHandle);
+  }
+}
+
+// Wait for the probe response; runs before the serial task exists, so a plain delay is fine
+static bool probeSerialLink(uint32_t baud) {
+  Serial1.updateBaudRate(baud);
+  delay(2);  // Let any partial byte at the old rate drain
+  setSerialFraming(true);
+  sendRangeRequest(14, 2);  // RPM, present in every firmware with the new protocol
+  SerialResponseStatus status;
+  while ((status = pollDataResponse(SERIAL_PROBE_TIMEOUT_MS)) == RESPONSE_PENDING) {
+    delay(1);
+  }
+  Serial.printf("[SERIAL] Probe %u baud (CRC framing): %s\n", baud, status == RESPONSE_COMPLETE ? "OK" : "no answer");
+  return status == RESPONSE_COMPLETE;
+}
+
+// Find the fastest baud the ECU answers framed requests on, else use the legacy protocol
+static uint32_t detectSerialLink() {
+  const uint32_t candidates[] = {921600, 460800, 230400, UART_BAUD};
+  const uint8_t candidateCount = sizeof(candidates) / sizeof(candidates[0]);
+
+  for (uint8_t i = 0; i < candidateCount; i++) {
+    if (probeSerialLink(candidates[i])) {
+      return candidates[i];
+    }
+  }
+
+  setSerialFraming(false);
+  Serial1.updateBaudRate(UART_BAUD);
+  Serial.println("[SERIAL] No framed response, using the legacy protocol");
+  return UART_BAUD;
+}
+
 void setupSerial() {
+  resetSerialStats();
   Serial1.begin(UART_BAUD, SERIAL_8N1, RXD, TXD);
-  Serial.printf("Serial mode setup complete. Pins: RX=%d, TX=%d, Baud=%d\n", RXD, TXD, UART_BAUD);
+  uint32_t baud = detectSerialLink();
+  // Wake the serial task as bytes arrive instead of polling the UART
+  Serial1.onReceive(onSerialReceive, false);
+  Serial.printf("Serial mode setup complete. Pins: RX=%d, TX=%d, Baud=%u, %s\n", RXD, TXD, baud,
+                isSerialFramed() ? "CRC framed" : "legacy");
 }
 
 void serialTask(void *pvParameters) {
   Serial.println("Serial communication task started on core 0");
-  
+  serialTaskHandle = xTaskGetCurrentTaskHandle();
+
+  startPollCycle();
   while (1) {
-    handleSerialCommunication();
-    vTaskDelay(1); // Allow other tasks to run
-  }
-}
+#if ENABLE_SIMULATOR
+    // Simulated data replaces the ECU from this task, so the channels keep one writer.
+    // Polling restarts from scratch afterwards; the reply in flight is abandoned.
+    if (getSimulatorMode() != SIMULATOR_MODE_OFF) {
+      updateSimulatorData();
+      vTaskDelay(pdMS_TO_TICKS(10));
+      if (getSimulatorMode() == SIMULATOR_MODE_OFF) {
+        startPollCycle();
+      }
+      continue;
+    }
+#endif
+    // Timeout tracks the measured round trip, so a lost reply costs little link time
+    uint16_t timeout = getSerialResponseTimeoutMs();
+    SerialResponseStatus status = pollDataResponse(timeout);
+    if (status == RESPONSE_PENDING) {
+      // Sleep until the UART reports more bytes or the request times out
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(getResponseWaitMs(timeout)) + 1);
+      continue;
+    }
 
-void handleSerialCommunication() {
-  static uint32_t lastUpdate = millis();
-  static uint32_t lastRefresh = millis();
-  
-  // Request data every 15ms for faster response (was 20ms)
-  if (millis() - lastUpdate > 15) {
-    requestData(30); // Reduced timeout from 50ms to 30ms
-    lastUpdate = millis();
+    if (status == RESPONSE_COMPLETE) {
+      recordSerialRequest(getLastRoundTripUs());
+      if (!advancePollCycle()) {
+        continue;  // Next range of the same poll is already on its way
+      }
+      publishDataFrame();
+      recordSerialPoll();
+    } else {
+      recordSerialFailure(status == RESPONSE_TIMEOUT);
+      failPollCycle();
+    }
+
+    handleSerialCommunication(status == RESPONSE_COMPLETE);
+
+    // Fire the next poll as soon as the previous one has finished, unless the
+    // link keeps failing; an error also yields so garbage on the line can't spin us
+    uint16_t backoff = getSerialBackoffMs();
+    if (backoff > 0) {
+      vTaskDelay(pdMS_TO_TICKS(backoff));
+    } else if (status == RESPONSE_ERROR) {
+      vTaskDelay(1);
+    }
+    startPollCycle();
   }
+}
 
+void handleSerialCommunication(bool frameReceived) {
   isCANMode = false;  // We're in Serial mode when this function is called
 
   uint32_t currentTime = millis();
-  uint32_t elapsed = currentTime - lastRefresh;
-  refreshRate = (elapsed > 0) ? (1000 / elapsed) : 0;
-  lastRefresh = currentTime;
+  updateSerialStatsRates(currentTime);
+  refreshRate = getSerialPollsPerSec();
   
-  // Update temperature and voltage data every 150ms (was 200ms)
-  if (currentTime - lazyUpdateTime > 150 || rpm < 100) {
-    clt = getByte(7) - 40;
-    iat = getByte(6) - 40;
-    bat = getByte(9) * 0.1;
-    lazyUpdateTime = currentTime;
+  // A failed poll leaves nothing new to decode
+  if (frameReceived) {
+    // Range reads only refreshed the fields of the current plan; 'n' carries them all
+    uint32_t mask = (useRangeReads && !probingFullPoll) ? rangePlan.sourceMask : 0xFFFFFFFF;
+    for (uint8_t i = 0; i < serialFieldCount; i++) {
+      const SerialField &field = serialFields[i];
+      if (!(mask & (1UL << field.bit))) {
+        continue;
+      }
+      int32_t raw;
+      if (field.flags & SERIAL_FIELD_BIT) {
+        raw = getBit(field.offset, field.bitIndex);
+      } else if (field.length == 2) {
+        raw = getWord(field.offset);
+      } else if (field.flags & SERIAL_FIELD_SIGNED) {
+        raw = (int8_t)getByte(field.offset);
+      } else {
+        raw = getByte(field.offset);
+      }
+
+      if (field.bit < DATA_SOURCE_COUNT) {
+        writeChannel(field.bit, raw * field.mul + field.add, currentTime);
+      } else {
+        writeIndicator(field.bit - DATA_SOURCE_COUNT, raw != 0);
+      }
+    }
+    publishTelemetry();
   }
-  
-  // Read primary engine data
-  rpm = getWord(14);
-  mapData = getWord(4);
-  afrConv = getByte(10) * 0.1;
-  tps = getByte(24) / 2.0;
-  adv = (int8_t)getByte(23);
-  fp = getByte(103);
-  vss = getWord(100);
-  
-  // Read status bits
-  syncStatus = getBit(31, 7);
-  ase = getBit(2, 2);
-  wue = getBit(2, 3);
-  rev = getBit(31, 2);
-  launch = getBit(31, 0);
-  airCon = getByte(122);
-  fan = getBit(106, 3);
-  dfco = getBit(1, 4);
 
   // Debug: Print data values occasionally
   static uint32_t lastDataDebug = 0;
   if (currentTime - lastDataDebug > 5000) { // Print every 5 seconds
-    Serial.printf("[SERIAL] RPM: %d, MAP: %.1f, TPS: %.1f, CLT: %d, IAT: %d\n", 
-                  rpm, mapData, tps, clt, iat);
-    Serial.printf("[SERIAL] AFR: %.2f, FP: %d, ADV: %d, RefreshRate: %dHz\n", 
-                  afrConv, fp, adv, refreshRate);
+    printChannels("SERIAL");
+    Serial.printf("[SERIAL] Poll rate: %u/s, CRC failures: %u\n", refreshRate, getSerialCrcFailures());
     lastDataDebug = currentTime;
   }
 }
@@ -5,7 +5,7 @@
 
 // Function declarations
 void setupSerial();
-void handleSerialCommunication();
+void handleSerialCommunication(bool frameReceived);
 void serialTask(void *pvParameters);
 
 #endif // SERIAL_HANDLER_H
@@ -0,0 +1,81 @@
+#include "SerialRangePlanner.h"
+
+// Gaps up to this many bytes are read through rather than split into another
+// request: each 'r' costs 7 bytes out, 2 header bytes back and an ECU turnaround
+#define SERIAL_RANGE_MERGE_GAP 16
+
+// Where each value lives in the Speeduino realtime block (same offsets as 'n')
+// and how to scale it into its channel's fixed-point unit
+const SerialField serialFields[] = {
+  // bit                                   offset len flags             bitIndex mul add
+  {DATA_SOURCE_IAT,                          6,   1,  0,                0,       10, -400},  // 1 C, offset -40
+  {DATA_SOURCE_COOLANT,                      7,   1,  0,                0,       10, -400},  // 1 C, offset -40
+  {DATA_SOURCE_AFR,                          10,  1,  0,                0,       1,  0},     // 0.1 AFR
+  {DATA_SOURCE_ADV,                          23,  1,  SERIAL_FIELD_SIGNED, 0,    10, 0},     // 1 deg
+  {DATA_SOURCE_TPS,                          24,  1,  0,                0,       5,  0},     // 0.5 %
+  {DATA_SOURCE_VOLTAGE,                      9,   1,  0,                0,       1,  0},     // 0.1 V
+  {DATA_SOURCE_MAP,                          4,   2,  0,                0,       10, 0},     // 1 kPa
+  {DATA_SOURCE_RPM,                          14,  2,  0,                0,       1,  0},     // 1 rpm
+  {DATA_SOURCE_FP,                           103, 1,  0,                0,       10, 0},
+  {DATA_SOURCE_VSS,                          100, 2,  0,                0,       10, 0},     // 1 km/h
+  {DATA_SOURCE_COUNT + INDICATOR_SYNC,       31,  1,  SERIAL_FIELD_BIT, 7,       1,  0},
+  {DATA_SOURCE_COUNT + INDICATOR_FAN,        106, 1,  SERIAL_FIELD_BIT, 3,       1,  0},
+  {DATA_SOURCE_COUNT + INDICATOR_ASE,        2,   1,  SERIAL_FIELD_BIT, 2,       1,  0},
+  {DATA_SOURCE_COUNT + INDICATOR_WUE,        2,   1,  SERIAL_FIELD_BIT, 3,       1,  0},
+  {DATA_SOURCE_COUNT + INDICATOR_REV,        31,  1,  SERIAL_FIELD_BIT, 2,       1,  0},
+  {DATA_SOURCE_COUNT + INDICATOR_LCH,        31,  1,  SERIAL_FIELD_BIT, 0,       1,  0},
+  {DATA_SOURCE_COUNT + INDICATOR_AC,         122, 1,  0,                0,       1,  0},     // Non-zero = on
+  {DATA_SOURCE_COUNT + INDICATOR_DFCO,       1,   1,  SERIAL_FIELD_BIT, 4,       1,  0},
+};
+
+#define SERIAL_FIELD_COUNT (sizeof(serialFields) / sizeof(serialFields[0]))
+
+const uint8_t serialFieldCount = SERIAL_FIELD_COUNT;
+
+void planSerialRanges(uint32_t sourceMask, SerialRangePlan &plan) {
+  plan.sourceMask = sourceMask;
+  plan.rangeCount = 0;
+  plan.totalBytes = 0;
+
+  // Collect the wanted spans sorted by offset (insertion sort, the table is tiny)
+  SerialRange spans[SERIAL_FIELD_COUNT];
+  uint8_t spanCount = 0;
+  for (uint8_t i = 0; i < SERIAL_FIELD_COUNT; i++) {
+    if (!(sourceMask & (1UL << serialFields[i].bit))) {
+      continue;
+    }
+    SerialRange span = {serialFields[i].offset, serialFields[i].length};
+    uint8_t j = spanCount++;
+    while (j > 0 && spans[j - 1].offset > span.offset) {
+      spans[j] = spans[j - 1];
+      j--;
+    }
+    spans[j] = span;
+  }
+
+  // Merge overlapping spans and spans separated by a small gap
+  for (uint8_t i = 0; i < spanCount; i++) {
+    uint16_t end = spans[i].offset + spans[i].length;
+    if (plan.rangeCount > 0) {
+      SerialRange &last = plan.ranges[plan.rangeCount - 1];
+      uint16_t lastEnd = last.offset + last.length;
+      if (spans[i].offset <= lastEnd + SERIAL_RANGE_MERGE_GAP) {
+        if (end > lastEnd) {
+          last.length = end - last.offset;
+        }
+        continue;
+      }
+    }
+    if (plan.rangeCount < SERIAL_MAX_RANGES) {
+      plan.ranges[plan.rangeCount++] = spans[i];
+      continue;
+    }
+    // Out of slots: fold the span into the closest previous range
+    SerialRange &last = plan.ranges[plan.rangeCount - 1];
+    last.length = end - last.offset;
+  }
+
+  for (uint8_t i = 0; i < plan.rangeCount; i++) {
+    plan.totalBytes += plan.ranges[i].length;
+  }
+}
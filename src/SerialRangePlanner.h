@@ -0,0 +1,48 @@
+#ifndef SERIAL_RANGE_PLANNER_H
+#define SERIAL_RANGE_PLANNER_H
+
+#include <stdint.h>
+#include "DisplayConfig.h"
+
+#define SERIAL_MAX_RANGES 6
+
+// Bit per value the layout needs, data sources first then indicators
+#define SERIAL_SOURCE_BIT(src) (1UL << (src))
+#define SERIAL_INDICATOR_BIT(ind) (1UL << (DATA_SOURCE_COUNT + (ind)))
+
+#define SERIAL_FIELD_SIGNED 0x01   // Sign-extend a 1-byte value
+#define SERIAL_FIELD_BIT    0x02   // Single status bit at bitIndex
+
+// One value in the Speeduino realtime block.
+// Channel value = raw * mul + add, in the channel's fixed-point unit; indicators are 0/1.
+struct SerialField {
+  uint8_t bit;        // Index into the source mask: DataSource, or DATA_SOURCE_COUNT + IndicatorSource
+  uint16_t offset;
+  uint8_t length;     // 1 or 2 bytes (little-endian)
+  uint8_t flags;      // SERIAL_FIELD_* flags
+  uint8_t bitIndex;
+  int16_t mul;
+  int16_t add;
+};
+
+extern const SerialField serialFields[];
+extern const uint8_t serialFieldCount;
+
+// One Speeduino 'r' read of the realtime (0x30) output channels
+struct SerialRange {
+  uint16_t offset;
+  uint16_t length;
+};
+
+// Minimal set of contiguous reads covering every value in sourceMask
+struct SerialRangePlan {
+  uint32_t sourceMask;
+  uint8_t rangeCount;
+  SerialRange ranges[SERIAL_MAX_RANGES];
+  uint16_t totalBytes;      // Data bytes fetched per poll, gaps included
+};
+
+// Function declarations
+void planSerialRanges(uint32_t sourceMask, SerialRangePlan &plan);
+
+#endif // SERIAL_RANGE_PLANNER_H
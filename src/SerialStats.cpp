@@ -0,0 +1,122 @@
+#include "SerialStats.h"
+#include "Config.h"
+#include "Comms.h"
+
+static SerialLinkStats linkStats;
+static uint32_t lastRateUpdate = 0;
+
+void resetSerialStats() {
+  memset(&linkStats, 0, sizeof(linkStats));
+  linkStats.minRttUs = UINT32_MAX;
+}
+
+// One request answered in full; feeds the RTT EWMA used for the adaptive timeout
+void recordSerialRequest(uint32_t roundTripUs) {
+  linkStats.requests++;
+  linkStats.consecutiveFailures = 0;
+  if (roundTripUs < linkStats.minRttUs) linkStats.minRttUs = roundTripUs;
+  if (roundTripUs > linkStats.maxRttUs) linkStats.maxRttUs = roundTripUs;
+
+  // RTT EWMA (1/8 weight), seeded with the first sample
+  if (linkStats.rttUs == 0) {
+    linkStats.rttUs = roundTripUs;
+  } else {
+    linkStats.rttUs = linkStats.rttUs + (((int32_t)roundTripUs - (int32_t)linkStats.rttUs) >> 3);
+  }
+
+  uint8_t bucket = roundTripUs ? 31 - __builtin_clz(roundTripUs) : 0;
+  if (bucket >= SERIAL_LATENCY_BUCKETS) {
+    bucket = SERIAL_LATENCY_BUCKETS - 1;
+  }
+  linkStats.latencyHist[bucket]++;
+}
+
+void recordSerialPoll() {
+  linkStats.polls++;
+  linkStats.windowPolls++;
+}
+
+void recordSerialFailure(bool timeout) {
+  if (timeout) {
+    linkStats.timeouts++;
+  } else {
+    linkStats.errors++;
+  }
+  if (linkStats.consecutiveFailures < 255) {
+    linkStats.consecutiveFailures++;
+  }
+}
+
+// Roll the 1 s poll-rate window. Cheap to call often; works once per second.
+void updateSerialStatsRates(uint32_t nowMs) {
+  uint32_t elapsed = nowMs - lastRateUpdate;
+  if (elapsed < 1000) {
+    return;
+  }
+  linkStats.pollsPerSec = linkStats.windowPolls * 1000 / elapsed;
+  linkStats.windowPolls = 0;
+  lastRateUpdate = nowMs;
+}
+
+// A few times the smoothed RTT: a lost reply is noticed quickly without
+// cutting off ones that are merely slow. Full timeout until the link is measured.
+uint16_t getSerialResponseTimeoutMs() {
+  if (linkStats.rttUs == 0 || linkStats.consecutiveFailures > 0) {
+    return SERIAL_RESPONSE_TIMEOUT_MS;
+  }
+  uint32_t timeoutMs = linkStats.rttUs * 4 / 1000 + 2;
+  return constrain(timeoutMs, SERIAL_RESPONSE_MIN_TIMEOUT_MS, SERIAL_RESPONSE_TIMEOUT_MS);
+}
+
+// Exponential backoff after consecutive failures so a dead ECU isn't hammered
+uint16_t getSerialBackoffMs() {
+  uint8_t failures = linkStats.consecutiveFailures;
+  if (failures < 2) {
+    return 0;
+  }
+  uint32_t backoff = (uint32_t)SERIAL_BACKOFF_BASE_MS << min(failures - 2, 8);
+  return min(backoff, (uint32_t)SERIAL_BACKOFF_MAX_MS);
+}
+
+uint32_t getSerialPollsPerSec() {
+  return linkStats.pollsPerSec;
+}
+
+void printSerialStats() {
+  Serial.println("=== SERIAL STATS ===");
+  Serial.printf("Polls: %u (%u/s), requests: %u, timeouts: %u, errors: %u, CRC failures: %u\n",
+                linkStats.polls, linkStats.pollsPerSec, linkStats.requests, linkStats.timeouts,
+                linkStats.errors, getSerialCrcFailures());
+  Serial.printf("RTT (us): min %u, avg %u, max %u, timeout %u ms, backoff %u ms\n",
+                linkStats.requests ? linkStats.minRttUs : 0, linkStats.rttUs, linkStats.maxRttUs,
+                getSerialResponseTimeoutMs(), getSerialBackoffMs());
+  Serial.print("Latency histogram (log2 us): ");
+  for (uint8_t b = 0; b < SERIAL_LATENCY_BUCKETS; b++) {
+    Serial.printf("%u ", linkStats.latencyHist[b]);
+  }
+  Serial.println();
+  Serial.println("====================");
+}
+
+String getSerialStatsJson() {
+  String json = "{";
+  json += "\"framed\":" + String(isSerialFramed() ? "true" : "false") + ",";
+  json += "\"polls\":" + String(linkStats.polls) + ",";
+  json += "\"pollsPerSec\":" + String(linkStats.pollsPerSec) + ",";
+  json += "\"requests\":" + String(linkStats.requests) + ",";
+  json += "\"timeouts\":" + String(linkStats.timeouts) + ",";
+  json += "\"errors\":" + String(linkStats.errors) + ",";
+  json += "\"crcFailures\":" + String(getSerialCrcFailures()) + ",";
+  json += "\"minRttUs\":" + String(linkStats.requests ? linkStats.minRttUs : 0) + ",";
+  json += "\"avgRttUs\":" + String(linkStats.rttUs) + ",";
+  json += "\"maxRttUs\":" + String(linkStats.maxRttUs) + ",";
+  json += "\"timeoutMs\":" + String(getSerialResponseTimeoutMs()) + ",";
+  json += "\"backoffMs\":" + String(getSerialBackoffMs()) + ",";
+  json += "\"latency\":[";
+  for (uint8_t b = 0; b < SERIAL_LATENCY_BUCKETS; b++) {
+    if (b > 0) json += ",";
+    json += String(linkStats.latencyHist[b]);
+  }
+  json += "]}";
+  return json;
+}
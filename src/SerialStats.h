@@ -0,0 +1,36 @@
+#ifndef SERIAL_STATS_H
+#define SERIAL_STATS_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define SERIAL_LATENCY_BUCKETS 16   // Bucket i counts round trips in [2^i, 2^(i+1)) us
+
+// Serial link poll statistics
+struct SerialLinkStats {
+  uint32_t polls;             // Completed polls (every read of the cycle answered)
+  uint32_t pollsPerSec;       // Rate over the last completed 1 s window
+  uint32_t windowPolls;       // Polls in the current window
+  uint32_t requests;          // Completed individual requests
+  uint32_t timeouts;
+  uint32_t errors;            // Bad header, length or CRC
+  uint32_t rttUs;             // Smoothed request round trip
+  uint32_t minRttUs;
+  uint32_t maxRttUs;
+  uint8_t consecutiveFailures;
+  uint32_t latencyHist[SERIAL_LATENCY_BUCKETS];
+};
+
+// Function declarations
+void resetSerialStats();
+void recordSerialRequest(uint32_t roundTripUs);
+void recordSerialPoll();
+void recordSerialFailure(bool timeout);
+void updateSerialStatsRates(uint32_t nowMs);
+uint16_t getSerialResponseTimeoutMs();
+uint16_t getSerialBackoffMs();
+uint32_t getSerialPollsPerSec();
+void printSerialStats();
+String getSerialStatsJson();
+
+#endif // SERIAL_STATS_H
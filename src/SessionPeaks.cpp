@@ -0,0 +1,141 @@
+#include "SessionPeaks.h"
+#include "Channels.h"
+#include "text_utils.h"
+#include <atomic>
+
+// Channels whose interesting extreme is the lowest one (battery sag, fuel pressure drop)
+#define PEAK_LOW_CHANNELS ((1UL << DATA_SOURCE_VOLTAGE) | (1UL << DATA_SOURCE_FP))
+
+// Written only by the ingest task via writeChannel(), at ingest rate so short spikes
+// between frames are kept. The sequence is odd while a write is in progress.
+static ChannelPeak peaks[CHANNEL_COUNT];
+static std::atomic<uint32_t> peakSequence(0);
+
+// Set by any task, applied by the ingest side on its next sample so there is one writer
+static std::atomic<bool> peakResetPending(true);
+
+// Render side: dash shows peaks instead of live values until this time
+static volatile uint32_t peakRecallUntilMs = 0;
+static volatile bool peakRecallActive = false;
+
+void recordPeak(uint8_t channel, int32_t value, uint32_t nowMs) {
+  if (channel >= CHANNEL_COUNT) {
+    return;
+  }
+  peakSequence.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (peakResetPending.exchange(false)) {
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+      peaks[i].min = INT32_MAX;
+      peaks[i].max = INT32_MIN;
+      peaks[i].minMs = peaks[i].maxMs = 0;
+    }
+  }
+  ChannelPeak &peak = peaks[channel];
+  if (value < peak.min) {
+    peak.min = value;
+    peak.minMs = nowMs;
+  }
+  if (value > peak.max) {
+    peak.max = value;
+    peak.maxMs = nowMs;
+  }
+
+  peakSequence.fetch_add(1, std::memory_order_release);
+}
+
+void requestPeakReset() {
+  peakResetPending.store(true);
+  Serial.println("[PEAKS] Session peaks reset");
+}
+
+// Lock-free copy of one channel's extremes; false if none recorded since the last reset
+bool readPeak(uint8_t channel, ChannelPeak &out) {
+  if (channel >= CHANNEL_COUNT || peakResetPending.load()) {
+    return false;
+  }
+  uint32_t before, after;
+  do {
+    before = peakSequence.load(std::memory_order_acquire);
+    out = peaks[channel];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = peakSequence.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+  return out.min <= out.max;
+}
+
+bool isPeakLow(uint8_t channel) {
+  return channel < CHANNEL_COUNT && (PEAK_LOW_CHANNELS & (1UL << channel));
+}
+
+// The extreme the dash recalls for a channel: minimum for PEAK_LOW_CHANNELS, else maximum
+int32_t getPeakRecallValue(uint8_t channel) {
+  ChannelPeak peak;
+  if (!readPeak(channel, peak)) {
+    return 0;
+  }
+  return isPeakLow(channel) ? peak.min : peak.max;
+}
+
+void startPeakRecall() {
+  peakRecallUntilMs = millis() + PEAK_RECALL_MS;
+  peakRecallActive = true;
+}
+
+void stopPeakRecall() {
+  peakRecallActive = false;
+}
+
+bool isPeakRecallActive() {
+  if (peakRecallActive && (int32_t)(millis() - peakRecallUntilMs) >= 0) {
+    peakRecallActive = false;
+  }
+  return peakRecallActive;
+}
+
+void printPeaks() {
+  char minBuf[22];
+  char maxBuf[22];
+  uint32_t now = millis();
+  Serial.println("=== SESSION PEAKS ===");
+  for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+    ChannelPeak peak;
+    if (!readPeak(i, peak)) {
+      continue;
+    }
+    formatValue(minBuf, peak.min, channelInfo[i].decimals);
+    formatValue(maxBuf, peak.max, channelInfo[i].decimals);
+    Serial.printf("%-8s min %8s%s (%lus ago)  max %8s%s (%lus ago)\n",
+                  channelInfo[i].name, minBuf, channelInfo[i].unit, (now - peak.minMs) / 1000,
+                  maxBuf, channelInfo[i].unit, (now - peak.maxMs) / 1000);
+  }
+  Serial.println("=====================");
+}
+
+String getPeaksJson() {
+  char buf[22];
+  uint32_t now = millis();
+  String json = "{";
+  json += "\"recall\":" + String(isPeakRecallActive() ? "true" : "false") + ",";
+  json += "\"channels\":[";
+  bool first = true;
+  for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+    ChannelPeak peak;
+    if (!readPeak(i, peak)) {
+      continue;
+    }
+    if (!first) json += ",";
+    first = false;
+    json += "{\"dataSource\":" + String(i) + ",";
+    json += "\"name\":\"" + String(channelInfo[i].name) + "\",";
+    formatValue(buf, peak.min, channelInfo[i].decimals);
+    json += "\"min\":" + String(buf) + ",";
+    json += "\"minAgoS\":" + String((now - peak.minMs) / 1000) + ",";
+    formatValue(buf, peak.max, channelInfo[i].decimals);
+    json += "\"max\":" + String(buf) + ",";
+    json += "\"maxAgoS\":" + String((now - peak.maxMs) / 1000) + "}";
+  }
+  json += "]}";
+  return json;
+}
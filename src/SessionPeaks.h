@@ -0,0 +1,35 @@
+#ifndef SESSION_PEAKS_H
+#define SESSION_PEAKS_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Config.h"
+#include "DisplayConfig.h"
+
+// Session peaks kept current even when no panel shows the channel:
+// max RPM, CLT and MAP, min battery voltage
+#define PEAK_SESSION_CHANNELS ((1UL << DATA_SOURCE_RPM) | (1UL << DATA_SOURCE_COOLANT) | \
+                               (1UL << DATA_SOURCE_MAP) | (1UL << DATA_SOURCE_VOLTAGE))
+
+// Running extremes of one channel since boot or the last reset.
+// Fixed-point like the channel value; min > max means no sample yet.
+struct ChannelPeak {
+  int32_t min;
+  int32_t max;
+  uint32_t minMs;   // millis() when the minimum was seen
+  uint32_t maxMs;
+};
+
+// Function declarations
+void recordPeak(uint8_t channel, int32_t value, uint32_t nowMs);
+void requestPeakReset();
+bool readPeak(uint8_t channel, ChannelPeak &out);
+bool isPeakLow(uint8_t channel);
+int32_t getPeakRecallValue(uint8_t channel);
+void startPeakRecall();
+void stopPeakRecall();
+bool isPeakRecallActive();
+void printPeaks();
+String getPeaksJson();
+
+#endif // SESSION_PEAKS_H
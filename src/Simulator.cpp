@@ -1,5 +1,5 @@
 #include "Simulator.h"
-#include "DataTypes.h"
+#include "Telemetry.h"
 #include "Config.h"
 #include "Arduino.h"
 
@@ -7,6 +7,7 @@ static uint8_t simulatorMode = SIMULATOR_MODE_OFF;
 static uint32_t lastSimUpdate = 0;
 static uint32_t simulatorStep = 0;
 static bool rpmIncreasing = true;
+static int rpm = 0;  // Simulated engine speed, every other value is derived from it
 
 void initializeSimulator() {
   simulatorMode = SIMULATOR_MODE_OFF;
@@ -123,6 +124,10 @@ void updateSimulatorData() {
       break;
   }
   
+  int mapData, tps, adv, fp, triggerError, vss, clt, iat;
+  float afrConv, bat;
+  bool syncStatus, fan, ase, wue, rev, launch, airCon, dfco;
+
   // Generate correlated sensor data based on RPM
   if (rpm == 0) {
     // Engine off
@@ -205,6 +210,28 @@ void updateSimulatorData() {
     tps = constrain(tps, 0, 100);
     adv = constrain(adv, -5, 40);
   }
+
+  // Channels are fixed-point, see channelInfo[] for each one's decimals
+  writeChannel(DATA_SOURCE_RPM, rpm, currentTime);
+  writeChannel(DATA_SOURCE_MAP, mapData * 10, currentTime);
+  writeChannel(DATA_SOURCE_TPS, tps * 10, currentTime);
+  writeChannel(DATA_SOURCE_ADV, adv * 10, currentTime);
+  writeChannel(DATA_SOURCE_AFR, lroundf(afrConv * 10), currentTime);
+  writeChannel(DATA_SOURCE_FP, fp * 10, currentTime);
+  writeChannel(DATA_SOURCE_TRIGGER, triggerError, currentTime);
+  writeChannel(DATA_SOURCE_VSS, vss * 10, currentTime);
+  writeChannel(DATA_SOURCE_COOLANT, clt * 10, currentTime);
+  writeChannel(DATA_SOURCE_IAT, iat * 10, currentTime);
+  writeChannel(DATA_SOURCE_VOLTAGE, lroundf(bat * 10), currentTime);
+  writeIndicator(INDICATOR_SYNC, syncStatus);
+  writeIndicator(INDICATOR_FAN, fan);
+  writeIndicator(INDICATOR_ASE, ase);
+  writeIndicator(INDICATOR_WUE, wue);
+  writeIndicator(INDICATOR_REV, rev);
+  writeIndicator(INDICATOR_LCH, launch);
+  writeIndicator(INDICATOR_AC, airCon);
+  writeIndicator(INDICATOR_DFCO, dfco);
+  publishTelemetry();
   
   // Print current values every 2 seconds
   static uint32_t lastPrint = 0;
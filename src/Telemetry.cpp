@@ -0,0 +1,83 @@
+#include "Telemetry.h"
+#include "Config.h"
+#include "DerivedChannels.h"
+#include "Arduino.h"
+#include <atomic>
+
+// Seqlock: odd sequence = write in progress. Writers never wait on readers,
+// readers retry until they copy a snapshot no writer touched meanwhile.
+static TelemetrySnapshot sharedTelemetry;
+static std::atomic<uint32_t> telemetrySequence(0);
+
+
+// Render-side copy, latched once per frame so every panel sees the same data
+static TelemetrySnapshot frameTelemetry;
+
+// Render side: one subtract and compare per panel against the latched snapshot
+bool isChannelStale(uint8_t channel, uint32_t nowMs) {
+  if (channel >= CHANNEL_COUNT) {
+    return false;
+  }
+  uint32_t updated = frameTelemetry.channels.updatedMs[channel];
+  if (updated == 0) {
+    return true;
+  }
+  uint32_t limit = (uint32_t)frameTelemetry.channels.periodMs[channel] * CHANNEL_STALE_PERIODS;
+  if (limit < CHANNEL_STALE_MIN_MS) {
+    limit = CHANNEL_STALE_MIN_MS;
+  }
+  return nowMs - updated > limit;
+}
+
+// Copy the ingest-side channel table into the shared snapshot. Call after each ingest batch.
+// Only the ingest task (CAN or Serial, which also runs the simulator) writes, so there is one writer.
+void publishTelemetry() {
+  evaluateDerivedChannels(millis());
+  const ChannelTable &channels = getIngestChannels();
+
+  uint32_t seq = telemetrySequence.load(std::memory_order_relaxed);
+  telemetrySequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(&sharedTelemetry.channels, &channels, sizeof(channels));
+  sharedTelemetry.sequence = (seq + 2) >> 1;
+  telemetrySequence.store(seq + 2, std::memory_order_release);
+}
+
+// Lock-free read of the latest complete snapshot
+void readTelemetry(TelemetrySnapshot &out) {
+  uint32_t before, after;
+  do {
+    before = telemetrySequence.load(std::memory_order_acquire);
+    memcpy(&out, &sharedTelemetry, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = telemetrySequence.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+}
+
+// Take this frame's snapshot for the renderer
+void latchTelemetry() {
+  readTelemetry(frameTelemetry);
+}
+
+const TelemetrySnapshot &getFrameTelemetry() {
+  return frameTelemetry;
+}
+
+// Fixed-point value of a channel in this frame's snapshot, see channelInfo[].decimals
+int32_t getChannelValue(uint8_t channel) {
+  return channel < CHANNEL_COUNT ? frameTelemetry.channels.value[channel] : 0;
+}
+
+// Same, before the channel's smoothing filter
+int32_t getChannelRawValue(uint8_t channel) {
+  return channel < CHANNEL_COUNT ? frameTelemetry.channels.raw[channel] : 0;
+}
+
+uint16_t getChannelChanges(uint8_t channel) {
+  return channel < CHANNEL_COUNT ? frameTelemetry.channels.changes[channel] : 0;
+}
+
+// AlarmSeverity computed on the ingest side when the sample was written
+uint8_t getChannelSeverity(uint8_t channel) {
+  return channel < CHANNEL_COUNT ? frameTelemetry.channels.severity[channel] : 0;
+}
@@ -0,0 +1,24 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "Channels.h"
+
+// Consistent copy of the channel table, published by the ingest task
+struct TelemetrySnapshot {
+  ChannelTable channels;
+  uint32_t sequence;      // Publish counter, changes on every update
+};
+
+// Function declarations
+void publishTelemetry();
+void readTelemetry(TelemetrySnapshot &out);
+void latchTelemetry();
+const TelemetrySnapshot &getFrameTelemetry();
+int32_t getChannelValue(uint8_t channel);
+int32_t getChannelRawValue(uint8_t channel);
+uint16_t getChannelChanges(uint8_t channel);
+uint8_t getChannelSeverity(uint8_t channel);
+bool isChannelStale(uint8_t channel, uint32_t nowMs);
+
+#endif // TELEMETRY_H
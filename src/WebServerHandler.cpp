@@ -2,6 +2,18 @@
 #include "Config.h"
 #include "DataTypes.h"
 #include "DisplayConfig.h"
+#include "DisplayManager.h"
+#include "CANStats.h"
+#include "SerialStats.h"
+#include "ChannelHistory.h"
+#include "DerivedChannels.h"
+#include "AlarmRules.h"
+#include "SessionPeaks.h"
+#include "ChannelFilter.h"
+#include "Compositor.h"
+#include "RenderTask.h"
+#include "Channels.h"
+#include "CANProtocols.h"
 #include <WiFi.h>
 #include <WebServer.h>
 #include <Update.h>
@@ -231,7 +243,11 @@ const char *uploadPage PROGMEM = R"rawliteral(
               'Debug Mode: ' + (data.debugMode ? 'ON' : 'OFF') + '<br>' +
               'Simulator: Mode ' + data.simulatorMode + '<br>' +
               'Uptime: ' + uptime + ' seconds<br>' +
-              'Free Memory: ' + Math.round(data.freeHeap / 1024) + 'KB';
+              'Free Memory: ' + Math.round(data.freeHeap / 1024) + 'KB (largest block ' + Math.round(data.largestFreeBlock / 1024) + 'KB)<br>' +
+              'Render Allocations: ' + data.renderSpriteAllocs + '<br>' +
+              'Pushed per Frame: ' + data.pushedBytesPerFrame + ' bytes (' + data.naiveBytesPerFrame + ' without compositor)<br>' +
+              'Panel Frame: ' + data.frameUs + ' us (raster ' + data.rasterUs + ' us, SPI wait ' + data.transferWaitUs +  us' + (data.dmaPush ? ', DMA' : '') + ')<br>' +
+              'Frame Time: p50 ' + data.frameP50Us + ' / p95 ' + data.frameP95Us + ' / p99 ' + data.frameP99Us + ' us of ' + data.frameBudgetUs + ' (' + data.frameOverruns + ' overruns)';
           })
           .catch(error => {
             console.error('Error fetching status:', error);
@@ -328,6 +344,26 @@ const char *uploadPage PROGMEM = R"rawliteral(
           alert('CAN speed updated: ' + speed + ' bps');
         });
       }
+      function updateCanProtocol() {
+        const select = document.getElementById('canProtocolSelect');
+        fetch('/canprotocol', {
+          method: 'POST',
+          headers: {'Content-Type': 'application/x-www-form-urlencoded'},
+          body: 'protocol=' + select.value
+        })
+        .then(response => response.text())
+        .then(data => {
+          alert('CAN protocol updated: ' + select.options[select.selectedIndex].text);
+        });
+      }
+      function loadCanProtocol() {
+        fetch('/canprotocol')
+          .then(response => response.text())
+          .then(protocol => {
+            const select = document.getElementById('canProtocolSelect');
+            if (select) select.value = protocol;
+          });
+      }
       function loadCanSpeed() {
         fetch('/canspeed')
           .then(response => response.text())
@@ -337,6 +373,139 @@ const char *uploadPage PROGMEM = R"rawliteral(
           });
       }
       
+      function updateDerived(slot) {
+        const body = 'slot=' + slot +
+          '&name=' + encodeURIComponent(document.getElementById('derivedName' + slot).value) +
+          '&expr=' + encodeURIComponent(document.getElementById('derivedExpr' + slot).value) +
+          '&decimals=' + document.getElementById('derivedDec' + slot).value;
+        fetch('/derived', {
+          method: 'POST',
+          headers: {'Content-Type': 'application/x-www-form-urlencoded'},
+          body: body
+        })
+        .then(response => response.text())
+        .then(data => {
+          alert('Derived ' + (slot + 1) + ': ' + data);
+        });
+      }
+      function loadDerived() {
+        fetch('/derived')
+          .then(response => response.json())
+          .then(data => {
+            for (let i = 0; i < data.channels.length; i++) {
+              const ch = data.channels[i];
+              document.getElementById('derivedName' + i).value = ch.name;
+              document.getElementById('derivedExpr' + i).value = ch.expression;
+              document.getElementById('derivedDec' + i).value = ch.decimals;
+            }
+          });
+      }
+      
+      function loadPeaks() {
+        fetch('/peaks')
+          .then(response => response.json())
+          .then(data => {
+            let html = '';
+            for (const ch of data.channels) {
+              html += ch.name + ': min ' + ch.min + ' (' + ch.minAgoS + 's ago), max ' + ch.max + ' (' + ch.maxAgoS + 's ago)<br>';
+            }
+            document.getElementById('peaks').innerHTML = html || 'No data yet';
+          });
+      }
+      function peakAction(action) {
+        fetch('/peaks', {
+          method: 'POST',
+          headers: {'Content-Type': 'application/x-www-form-urlencoded'},
+          body: 'action=' + action
+        })
+        .then(response => response.text())
+        .then(data => {
+          loadPeaks();
+        });
+      }
+      
+      let channelFilters = [];
+      function loadFilters() {
+        fetch('/filters')
+          .then(response => response.json())
+          .then(data => {
+            channelFilters = data.channels;
+            const select = document.getElementById('filterChannel');
+            if (select.options.length === 0) {
+              for (const f of data.channels) {
+                select.add(new Option(f.name, f.dataSource));
+              }
+            }
+            document.getElementById('filterSaved').textContent = data.savedRedrawsPerSec;
+            showFilter();
+          });
+      }
+      function showFilter() {
+        const f = channelFilters[document.getElementById('filterChannel').value];
+        if (!f) return;
+        document.getElementById('filterType').value = f.type;
+        document.getElementById('filterParam').value = f.param;
+      }
+      function updateFilter() {
+        fetch('/filters', {
+          method: 'POST',
+          headers: {'Content-Type': 'application/x-www-form-urlencoded'},
+          body: 'ch=' + document.getElementById('filterChannel').value +
+            '&type=' + document.getElementById('filterType').value +
+            '&param=' + encodeURIComponent(document.getElementById('filterParam').value)
+        })
+        .then(response => response.text())
+        .then(data => {
+          alert('Filter: ' + data);
+          loadFilters();
+        });
+      }
+      
+      let alarmRules = [];
+      function loadAlarms() {
+        fetch('/alarms')
+          .then(response => response.json())
+          .then(data => {
+            alarmRules = data;
+            const select = document.getElementById('alarmChannel');
+            if (select.options.length === 0) {
+              for (const rule of data) {
+                select.add(new Option(rule.name, rule.dataSource));
+              }
+            }
+            showAlarm();
+          });
+      }
+      function showAlarm() {
+        const rule = alarmRules[document.getElementById('alarmChannel').value];
+        if (!rule) return;
+        document.getElementById('alarmWarnLow').value = (rule.flags & 1) ? rule.warnLow : '';
+        document.getElementById('alarmWarnHigh').value = (rule.flags & 2) ? rule.warnHigh : '';
+        document.getElementById('alarmCritLow').value = (rule.flags & 4) ? rule.critLow : '';
+        document.getElementById('alarmCritHigh').value = (rule.flags & 8) ? rule.critHigh : '';
+        document.getElementById('alarmHyst').value = rule.hysteresis;
+        document.getElementById('alarmDebounce').value = rule.debounceMs;
+      }
+      function updateAlarm() {
+        const fields = ['WarnLow', 'WarnHigh', 'CritLow', 'CritHigh'];
+        let body = 'ch=' + document.getElementById('alarmChannel').value;
+        for (const f of fields) {
+          body += '&' + f.charAt(0).toLowerCase() + f.slice(1) + '=' + encodeURIComponent(document.getElementById('alarm' + f).value);
+        }
+        body += '&hyst=' + document.getElementById('alarmHyst').value +
+          '&debounce=' + document.getElementById('alarmDebounce').value;
+        fetch('/alarms', {
+          method: 'POST',
+          headers: {'Content-Type': 'application/x-www-form-urlencoded'},
+          body: body
+        })
+        .then(response => response.text())
+        .then(data => {
+          alert('Alarm rule: ' + data);
+          loadAlarms();
+        });
+      }
+      
       const startTime = Date.now()/1000;
       setInterval(refreshStatus, 1000);
       
@@ -344,6 +513,11 @@ const char *uploadPage PROGMEM = R"rawliteral(
       window.onload = function() {
         loadDisplayConfig();
         loadCanSpeed();
+        loadCanProtocol();
+        loadDerived();
+        loadAlarms();
+        loadPeaks();
+        loadFilters();
       };
     </script>
   </head>
@@ -382,6 +556,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -399,6 +577,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -416,6 +598,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -433,6 +619,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -450,6 +640,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -467,6 +661,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -484,6 +682,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -501,6 +703,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
           <div class="config-item">
@@ -518,6 +724,10 @@ const char *uploadPage PROGMEM = R"rawliteral(
               <option value="8">RPM</option>
               <option value="9">FP</option>
               <option value="10">VSS</option>
+              <option value="11">Derived 1</option>
+              <option value="12">Derived 2</option>
+              <option value="13">Derived 3</option>
+              <option value="14">Derived 4</option>
             </select>
           </div>
         </div>
@@ -551,6 +761,107 @@ const char *uploadPage PROGMEM = R"rawliteral(
         </p>
       </div>
       
+      <div class="section">
+        <h2>Session Peaks</h2>
+        <div id="peaks" style="font-size: 14px;">Loading...</div>
+        <div class="grid">
+          <button class="btn" onclick="loadPeaks()">Refresh</button>
+          <button class="btn" onclick="peakAction('recall')">Show on Dash</button>
+        </div>
+        <div class="grid">
+          <button class="btn danger" onclick="peakAction('reset')">Reset Peaks</button>
+        </div>
+      </div>
+      
+      <div class="section">
+        <h2>Smoothing Filters</h2>
+        <div class="config-item">
+          <label for="filterChannel">Channel:</label>
+          <select id="filterChannel" onchange="showFilter()"></select>
+        </div>
+        <div class="config-item">
+          <label for="filterType">Filter / parameter:</label>
+          <select id="filterType">
+            <option value="none">None</option>
+            <option value="ema">EMA</option>
+            <option value="median">Median</option>
+            <option value="deadband">Deadband</option>
+          </select>
+          <input type="text" id="filterParam" size="6">
+          <button class="btn" onclick="updateFilter()">Set</button>
+        </div>
+        <p style="font-size: 14px; opacity: 0.8;">
+          EMA: strength 1-4 (higher is smoother). Median: window of 3 or 5 samples.
+          Deadband: smallest change shown, in the channel's unit.<br>
+          Panel redraws saved: <span id="filterSaved">-</span>/s
+        </p>
+      </div>
+      
+      <div class="section">
+        <h2>Alarm Rules</h2>
+        <div class="config-item">
+          <label for="alarmChannel">Channel:</label>
+          <select id="alarmChannel" onchange="showAlarm()"></select>
+        </div>
+        <div class="config-item">
+          <label>Warn below / above:</label>
+          <input type="text" id="alarmWarnLow" size="6">
+          <input type="text" id="alarmWarnHigh" size="6">
+        </div>
+        <div class="config-item">
+          <label>Critical below / above:</label>
+          <input type="text" id="alarmCritLow" size="6">
+          <input type="text" id="alarmCritHigh" size="6">
+        </div>
+        <div class="config-item">
+          <label>Hysteresis / debounce (ms):</label>
+          <input type="text" id="alarmHyst" size="6">
+          <input type="text" id="alarmDebounce" size="6">
+          <button class="btn" onclick="updateAlarm()">Set</button>
+        </div>
+        <p style="font-size: 14px; opacity: 0.8;">
+          Values are in the channel's display unit; leave a bound empty to disable it.
+          Warnings show in yellow and critical values in red.
+        </p>
+      </div>
+      
+      <div class="section">
+        <h2>Derived Channels</h2>
+        <div class="config-item">
+          <label>Derived 1:</label>
+          <input type="text" id="derivedName0" maxlength="7" size="6">
+          <input type="text" id="derivedExpr0" maxlength="47">
+          <select id="derivedDec0"><option value="0">0</option><option value="1">1</option><option value="2">2</option><option value="3">3</option></select>
+          <button class="btn" onclick="updateDerived(0)">Set</button>
+        </div>
+        <div class="config-item">
+          <label>Derived 2:</label>
+          <input type="text" id="derivedName1" maxlength="7" size="6">
+          <input type="text" id="derivedExpr1" maxlength="47">
+          <select id="derivedDec1"><option value="0">0</option><option value="1">1</option><option value="2">2</option><option value="3">3</option></select>
+          <button class="btn" onclick="updateDerived(1)">Set</button>
+        </div>
+        <div class="config-item">
+          <label>Derived 3:</label>
+          <input type="text" id="derivedName2" maxlength="7" size="6">
+          <input type="text" id="derivedExpr2" maxlength="47">
+          <select id="derivedDec2"><option value="0">0</option><option value="1">1</option><option value="2">2</option><option value="3">3</option></select>
+          <button class="btn" onclick="updateDerived(2)">Set</button>
+        </div>
+        <div class="config-item">
+          <label>Derived 4:</label>
+          <input type="text" id="derivedName3" maxlength="7" size="6">
+          <input type="text" id="derivedExpr3" maxlength="47">
+          <select id="derivedDec3"><option value="0">0</option><option value="1">1</option><option value="2">2</option><option value="3">3</option></select>
+          <button class="btn" onclick="updateDerived(3)">Set</button>
+        </div>
+        <p style="font-size: 14px; opacity: 0.8;">
+          Name, expression and decimal places. Use channel names (RPM, MAP, AFR, CLT, BAT, TPS, VSS, ...),
+          numbers, + - * / ( ) and min(a, b), max(a, b), abs(a). Example: <code>(MAP - 101.3) * 0.145</code> for boost in psi.<br>
+          Derived 1-4 can then be picked as a data source for any panel.
+        </p>
+      </div>
+      
       <div class="section">
         <h2>Debug & Testing</h2>
         <div class="grid">
@@ -641,10 +952,21 @@ const char *uploadPage PROGMEM = R"rawliteral(
         <div class="config-item">
           <label for="canSpeedSelect">CAN Speed:</label>
           <select id="canSpeedSelect" onchange="updateCanSpeed()">
+            <option value="125000">125 Kbps</option>
+            <option value="250000">250 Kbps</option>
             <option value="500000">500 Kbps</option>
             <option value="1000000">1 Mbps</option>
           </select>
         </div>
+        <div class="config-item">
+          <label for="canProtocolSelect">ECU Protocol:</label>
+          <select id="canProtocolSelect" onchange="updateCanProtocol()">
+            <option value="255">Auto-detect</option>
+            <option value="0">Haltech</option>
+            <option value="1">rusEFI</option>
+            <option value="2">MS Dash</option>
+          </select>
+        </div>
         <p style="font-size: 14px; opacity: 0.8;">
           Pilih kecepatan CAN sesuai kebutuhan hardware/ECU Anda.<br>
           Perubahan akan disimpan dan digunakan saat restart berikutnya.
@@ -741,7 +1063,25 @@ void startWebServer()
               json += "\"simulatorMode\":0,";
 #endif
               json += "\"uptime\":" + String(millis() / 1000) + ",";
-              json += "\"freeHeap\":" + String(ESP.getFreeHeap()) + "";
+              json += "\"freeHeap\":" + String(ESP.getFreeHeap()) + ",";
+              json += "\"largestFreeBlock\":" + String(ESP.getMaxAllocHeap()) + ",";
+              json += "\"renderSpriteAllocs\":" + String(getRenderSpriteAllocations()) + ",";
+              const CompositorStats &comp = getCompositorStats();
+              json += "\"pushedBytesPerFrame\":" + String(comp.frames ? comp.totalBytes / comp.frames : 0) + ",";
+              json += "\"naiveBytesPerFrame\":" + String(comp.frames ? comp.totalNaiveBytes / comp.frames : 0) + ",";
+              json += "\"frameUs\":" + String(comp.lastFrameUs) + ",";
+              json += "\"rasterUs\":" + String(comp.lastRasterUs) + ",";
+              json += "\"transferWaitUs\":" + String(comp.lastTransferWaitUs) + ",";
+              json += "\"dmaPush\":" + String(isCompositorDMA() ? "true" : "false") + ",";
+              FrameTimeStats frame;
+              getFrameTimeStats(frame);
+              json += "\"frameP50Us\":" + String(frame.p50Us) + ",";
+              json += "\"frameP95Us\":" + String(frame.p95Us) + ",";
+              json += "\"frameP99Us\":" + String(frame.p99Us) + ",";
+              json += "\"frameMaxUs\":" + String(frame.maxUs) + ",";
+              json += "\"frameBudgetUs\":" + String(frame.budgetUs) + ",";
+              json += "\"frameOverruns\":" + String(frame.overruns) + ",";
+              json += "\"deferredWidgets\":" + String(frame.deferredWidgets);
               json += "}";
               server.send(200, "application/json", json);
             });
@@ -786,6 +1126,14 @@ void startWebServer()
                         currentDisplayConfig.panels[position].dataType = DATA_TYPE_INT;
                         currentDisplayConfig.panels[position].decimals = 0;
                         break;
+                      case DATA_SOURCE_DERIVED_1:
+                      case DATA_SOURCE_DERIVED_2:
+                      case DATA_SOURCE_DERIVED_3:
+                      case DATA_SOURCE_DERIVED_4:
+                        currentDisplayConfig.panels[position].dataType = DATA_TYPE_FLOAT;
+                        currentDisplayConfig.panels[position].decimals =
+                          currentDisplayConfig.derived[dataSource - DATA_SOURCE_DERIVED_1].decimals;
+                        break;
                       default:
                         currentDisplayConfig.panels[position].dataType = DATA_TYPE_INT;
                         currentDisplayConfig.panels[position].decimals = 0;
@@ -797,6 +1145,7 @@ void startWebServer()
                   }
                 }
               }
+              requestPanelLayout();
               
               server.send(200, "text/plain", "Panel configured");
             });
@@ -812,6 +1161,7 @@ void startWebServer()
                 currentDisplayConfig.indicators[indicator].position = indicator;
                 strcpy(currentDisplayConfig.indicators[indicator].label, getIndicatorName(indicator));
               }
+              requestPanelLayout();
               
               server.send(200, "text/plain", "Indicator configured");
             });
@@ -857,8 +1207,68 @@ void startWebServer()
               server.send(200, "application/json", json);
             });
   
+  // Per-ID CAN broadcast rates, inter-arrival jitter and bus error counters
+  server.on("/canstats", HTTP_GET, [&]()
+            {
+              server.send(200, "application/json", getCANStatsJson());
+            });
+  server.on("/canstats/reset", HTTP_POST, [&]()
+            {
+              requestCANStatsReset();
+              server.send(200, "text/plain", "OK");
+            });
+  
+  server.on("/serialstats", HTTP_GET, [&]()
+            {
+              server.send(200, "application/json", getSerialStatsJson());
+            });
+  
+  // Channel history export: /history?ch=<DataSource>&tier=<0 = newest per 100 ms, 1 = 1 s, 2 = 10 s>
+  server.on("/history", HTTP_GET, [&]()
+            {
+              if (!server.hasArg("ch")) {
+                server.send(400, "text/plain", "Missing ch");
+                return;
+              }
+              int channel = server.arg("ch").toInt();
+              int tier = server.hasArg("tier") ? server.arg("tier").toInt() : HISTORY_TIER_SECOND;
+              if (channel < 0 || channel >= DATA_SOURCE_COUNT || tier < 0 || tier >= HISTORY_TIER_COUNT) {
+                server.send(400, "text/plain", "Invalid ch or tier");
+                return;
+              }
+              server.send(200, "application/json", getHistoryJson(channel, tier));
+            });
+  
+  // Session min/max per channel; POST action=reset clears them, action=recall shows them on the dash
+  server.on("/peaks", HTTP_GET, [&]()
+            {
+              server.send(200, "application/json", getPeaksJson());
+            });
+  server.on("/peaks", HTTP_POST, [&]()
+            {
+              String action = server.arg("action");
+              if (action == "reset") {
+                requestPeakReset();
+              } else if (action == "recall") {
+                startPeakRecall();
+              } else {
+                server.send(400, "text/plain", "Invalid action");
+                return;
+              }
+              server.send(200, "text/plain", "OK");
+            });
+  
+  server.on("/filters", HTTP_GET, handleFilters);
+  server.on("/filters", HTTP_POST, handleFilters);
+  server.on("/alarms", HTTP_GET, handleAlarms);
+  server.on("/alarms", HTTP_POST, handleAlarms);
+  server.on("/derived", HTTP_GET, handleDerived);
+  server.on("/derived", HTTP_POST, handleDerived);
+  
   server.on("/canspeed", HTTP_GET, handleCanSpeed);
   server.on("/canspeed", HTTP_POST, handleCanSpeed);
+  server.on("/canprotocol", HTTP_GET, handleCanProtocol);
+  server.on("/canprotocol", HTTP_POST, handleCanProtocol);
   
   server.begin();
   wifiActive = true;
@@ -963,7 +1373,7 @@ void handleCanSpeed() {
   } else if (server.method() == HTTP_POST) {
     if (server.hasArg("speed")) {
       uint32_t speed = server.arg("speed").toInt();
-      if (speed == 500000 || speed == 1000000) {
+      if (isValidCanSpeed(speed)) {
         setCanSpeed(speed);
         server.send(200, "text/plain", "OK");
         Serial.printf("CAN speed set to %u bps via webserver\n", speed);
@@ -978,6 +1388,161 @@ void handleCanSpeed() {
   }
 }
 
+void handleCanProtocol() {
+  if (server.method() == HTTP_GET) {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%u", getCanProtocol());
+    server.send(200, "text/plain", buf);
+  } else if (server.method() == HTTP_POST) {
+    if (server.hasArg("protocol")) {
+      long protocol = server.arg("protocol").toInt();
+      if ((protocol >= 0 && protocol < CAN_PROTOCOL_COUNT) || protocol == CAN_PROTOCOL_AUTO) {
+        setCanProtocol((uint8_t)protocol);
+        server.send(200, "text/plain", "OK");
+        Serial.printf("CAN protocol set to %ld via webserver\n", protocol);
+      } else {
+        server.send(400, "text/plain", "Invalid protocol");
+      }
+    } else {
+      server.send(400, "text/plain", "Missing protocol param");
+    }
+  } else {
+    server.send(405, "text/plain", "Method Not Allowed");
+  }
+}
+
+// Derived channels: GET lists expressions and evaluation cost,
+// POST slot=<0-3>&name=&expr=&decimals= compiles and saves one
+void handleDerived() {
+  if (server.method() == HTTP_GET) {
+    server.send(200, "application/json", getDerivedJson());
+  } else if (server.method() == HTTP_POST) {
+    if (!server.hasArg("slot") || !server.hasArg("expr")) {
+      server.send(400, "text/plain", "Missing slot or expr param");
+      return;
+    }
+    // slot and decimals are range-checked as long before narrowing to uint8_t, so 256 can't wrap to 0
+    long slot = server.arg("slot").toInt();
+    String name = server.hasArg("name") ? server.arg("name") : String("D") + String(slot + 1);
+    String expression = server.arg("expr");
+    long decimals = server.hasArg("decimals") ? server.arg("decimals").toInt() : 1;
+    const char *error = NULL;
+    if (!checkDerivedExpression(expression.c_str(), &error)) {
+      server.send(400, "text/plain", error);
+    } else if (slot < 0 || slot >= DERIVED_CHANNEL_COUNT || decimals < 0 || decimals > 3 ||
+               !setDerivedChannel(slot, name.c_str(), expression.c_str(), decimals)) {
+      server.send(400, "text/plain", "Invalid slot, name or decimals");
+    } else {
+      server.send(200, "text/plain", "OK");
+    }
+  } else {
+    server.send(405, "text/plain", "Method Not Allowed");
+  }
+}
+
+// Parse a value given in display units into the channel's fixed-point.
+// Missing or empty sets `present` false; false if it doesn't fit the config field.
+static bool parseFixedArg(const char *arg, uint8_t decimals, int16_t &out, bool &present) {
+  static const float scale[] = {1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f};
+  present = server.hasArg(arg) && server.arg(arg).length() > 0;
+  out = 0;
+  if (!present) {
+    return true;
+  }
+  long fixed = lroundf(server.arg(arg).toFloat() * scale[decimals]);
+  if (fixed < INT16_MIN || fixed > INT16_MAX) {
+    return false;
+  }
+  out = fixed;
+  return true;
+}
+
+// Alarm rules: GET lists all channels, POST ch=<DataSource> with
+// warnLow/warnHigh/critLow/critHigh/hyst in display units and debounce in ms
+void handleAlarms() {
+  if (server.method() == HTTP_GET) {
+    server.send(200, "application/json", getAlarmRulesJson());
+  } else if (server.method() == HTTP_POST) {
+    if (!server.hasArg("ch")) {
+      server.send(400, "text/plain", "Missing ch param");
+      return;
+    }
+    long channel = server.arg("ch").toInt();
+    if (channel < 0 || channel >= DATA_SOURCE_COUNT) {
+      server.send(400, "text/plain", "Invalid ch");
+      return;
+    }
+    uint8_t decimals = channelInfo[channel].decimals;
+    AlarmRuleConfig rule = {};
+    const char *boundArgs[] = {"warnLow", "warnHigh", "critLow", "critHigh"};
+    const uint8_t boundFlags[] = {ALARM_WARN_LOW, ALARM_WARN_HIGH, ALARM_CRIT_LOW, ALARM_CRIT_HIGH};
+    int16_t *bounds[] = {&rule.warnLow, &rule.warnHigh, &rule.critLow, &rule.critHigh};
+    bool present;
+    for (uint8_t i = 0; i < 4; i++) {
+      if (!parseFixedArg(boundArgs[i], decimals, *bounds[i], present)) {
+        server.send(400, "text/plain", "Value out of range");
+        return;
+      }
+      if (present) {
+        rule.flags |= boundFlags[i];
+      }
+    }
+    int16_t hysteresis;
+    long debounce = server.hasArg("debounce") ? server.arg("debounce").toInt() : 0;
+    if (!parseFixedArg("hyst", decimals, hysteresis, present) || hysteresis < 0 ||
+        debounce < 0 || debounce > 60000) {
+      server.send(400, "text/plain", "Value out of range");
+      return;
+    }
+    rule.hysteresis = hysteresis;
+    rule.debounceMs = debounce;
+    setAlarmRule(channel, rule);
+    server.send(200, "text/plain", "OK");
+  } else {
+    server.send(405, "text/plain", "Method Not Allowed");
+  }
+}
+
+// Channel filters: POST ch=<DataSource>&type=<none|ema|median|deadband>&param=
+// (deadband in display units)
+void handleFilters() {
+  if (server.method() == HTTP_GET) {
+    server.send(200, "application/json", getFiltersJson());
+  } else if (server.method() == HTTP_POST) {
+    if (!server.hasArg("ch") || !server.hasArg("type")) {
+      server.send(400, "text/plain", "Missing ch or type param");
+      return;
+    }
+    long channel = server.arg("ch").toInt();
+    String typeName = server.arg("type");
+    uint8_t type;
+    if (typeName == "none") type = FILTER_NONE;
+    else if (typeName == "ema") type = FILTER_EMA;
+    else if (typeName == "median") type = FILTER_MEDIAN;
+    else if (typeName == "deadband") type = FILTER_DEADBAND;
+    else {
+      server.send(400, "text/plain", "Invalid type");
+      return;
+    }
+    if (channel < 0 || channel >= DATA_SOURCE_COUNT) {
+      server.send(400, "text/plain", "Invalid ch");
+      return;
+    }
+    long param = server.arg("param").toInt();
+    if (type == FILTER_DEADBAND) {
+      static const float scale[] = {1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f};
+      param = lroundf(server.arg("param").toFloat() * scale[channelInfo[channel].decimals]);
+    }
+    if (param < 0 || param > 255 || !setChannelFilter(channel, type, param)) {
+      server.send(400, "text/plain", "Invalid param for this filter");
+      return;
+    }
+    server.send(200, "text/plain", "OK");
+  } else {
+    server.send(405, "text/plain", "Method Not Allowed");
+  }
+}
+
 void handleWebServerClients()
 {
   static uint32_t lastClientCheck = 0;
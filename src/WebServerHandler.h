@@ -20,6 +20,10 @@ extern "C" {
 #endif
 
 void handleCanSpeed();
+void handleCanProtocol();
+void handleDerived();
+void handleAlarms();
+void handleFilters();
 
 #ifdef __cplusplus
 }
@@ -9,10 +9,17 @@
 #include "DataTypes.h"
 #include "BacklightControl.h"
 #include "CANHandler.h"
+#include "CANStats.h"
+#include "SerialStats.h"
+#include "SessionPeaks.h"
+#include "ChannelFilter.h"
+#include "Compositor.h"
+#include "RenderTask.h"
 #include "SerialHandler.h"
 #include "DisplayManager.h"
 #include "WebServerHandler.h"
 #include "GlobalVariables.h"
+#include "Telemetry.h"
 
 // Include legacy headers for compatibility
 #include "Comms.h"
@@ -101,11 +108,49 @@ void handleSerialCommands()
         Serial.println("d = Toggle debug mode");
         Serial.println("i = Show system info");
 #endif
+        Serial.println("CAN COMMANDS:");
+        Serial.println("c = Show CAN bus statistics");
+        Serial.println("x = Reset CAN bus statistics");
+        Serial.println("SERIAL COMMANDS:");
+        Serial.println("s = Show serial link statistics");
+        Serial.println("PEAK COMMANDS:");
+        Serial.println("p = Show session peaks (and on the dash)");
+        Serial.println("r = Reset session peaks");
+        Serial.println("DISPLAY COMMANDS:");
+        Serial.println("b = Benchmark panel redraw (font path vs glyph atlas)");
         Serial.println("NETWORK COMMANDS:");
         Serial.println("w = Restart WiFi/Web Server");
         Serial.println("h = Show this help");
         Serial.println("===================");
         break;
+      case 'c':
+      case 'C':
+        // Show per-ID CAN bus statistics
+        printCANStats();
+        break;
+      case 'x':
+      case 'X':
+        requestCANStatsReset();
+        break;
+      case 's':
+      case 'S':
+        // Show serial link poll statistics
+        printSerialStats();
+        break;
+      case 'p':
+      case 'P':
+        // Print session min/max and show them on the dash for PEAK_RECALL_MS
+        printPeaks();
+        startPeakRecall();
+        break;
+      case 'r':
+      case 'R':
+        requestPeakReset();
+        break;
+      case 'b':
+      case 'B':
+        requestPanelRedrawBenchmark();
+        break;
       case 'w':
       case 'W':
         // Restart WiFi/Web Server
@@ -148,28 +193,32 @@ void updateCpuUsage()
   }
 }
 
-// Calculate FPS (frames per second)
+// Calculate FPS (frames per second) from the render task's frame counter.
+// Only the render task writes frameCount; this side keeps its own last reading.
 void updateFPS()
 {
-  frameCount++;
+  static uint32_t lastFrameCount = 0;
   uint32_t currentTime = millis();
+  uint32_t frames = frameCount;
   
   if (lastFpsUpdate == 0) {
     lastFpsUpdate = currentTime;
+    lastFrameCount = frames;
     fps = 0.0;
     return;
   }
   
   if (currentTime - lastFpsUpdate >= 1000) { // Update every second
     float timeDelta = (float)(currentTime - lastFpsUpdate) / 1000.0;
-    fps = (float)frameCount / timeDelta;
-    frameCount = 0;
+    uint32_t framesDrawn = frames - lastFrameCount;
+    fps = (float)framesDrawn / timeDelta;
+    lastFrameCount = frames;
     lastFpsUpdate = currentTime;
     
     // Debug print FPS calculation
     if (debugMode) {
-      Serial.printf("[DEBUG] FPS calc - Frames: %d, Delta: %.2fs, FPS: %.1f\n", 
-                    frameCount, timeDelta, fps);
+      Serial.printf("[DEBUG] FPS calc - Frames: %u, Delta: %.2fs, FPS: %.1f\n", 
+                    framesDrawn, timeDelta, fps);
     }
   }
 }
@@ -188,9 +237,21 @@ void printDebugInfo()
     Serial.println("=== DEBUG INFO ===");
     Serial.printf("CPU Usage: %.1f%%\n", cpuUsage);
     Serial.printf("FPS: %.1f\n", fps);
+    Serial.printf("Redraws saved by filters: %u/s\n", getSavedRedrawsPerSec());
     Serial.printf("Free Heap: %d bytes\n", ESP.getFreeHeap());
     Serial.printf("Min Free Heap: %d bytes\n", ESP.getMinFreeHeap());
-    Serial.printf("RPM: %d\n", rpm);
+    Serial.printf("Largest Free Block: %d bytes\n", ESP.getMaxAllocHeap());
+    Serial.printf("Sprite Allocations: %u layout, %u render (%u bytes held)\n",
+                  getLayoutSpriteAllocations(), getRenderSpriteAllocations(), getPanelSpriteBytes());
+    const CompositorStats &comp = getCompositorStats();
+    Serial.printf("Compositor: %u bytes in %u windows last frame (%u pushing whole widgets), avg %u bytes/frame\n",
+                  comp.lastFrameBytes, comp.lastFrameWindows, comp.lastFrameNaiveBytes,
+                  comp.frames ? comp.totalBytes / comp.frames : 0);
+    Serial.printf("Panel Frame: %uus (raster %uus, waiting on SPI %uus, %s)\n",
+                  comp.lastFrameUs, comp.lastRasterUs, comp.lastTransferWaitUs,
+                  isCompositorDMA() ? "DMA" : "blocking");
+    printFrameTimeStats();
+    Serial.printf("RPM: %d\n", getChannelValue(DATA_SOURCE_RPM));
     Serial.printf("Loop Time: %dms\n", millis() - loopStartTime);
     Serial.printf("Uptime: %ds\n", (currentTime - startupTime) / 1000);
     Serial.printf("WiFi Active: %s\n", wifiActive ? "true" : "false");
@@ -267,7 +328,6 @@ void setup()
   debugMode = false;
   cpuUsage = 0.0;
   fps = 0.0;
-  frameCount = 0;
   lastFpsUpdate = 0;  // Reset to 0 for proper initialization
   lastCpuMeasure = 0; // Reset to 0 for proper initialization
   
@@ -282,6 +342,7 @@ void setup()
   EEPROM.write(0, 1);
   delay(500);
   startUpDisplay();
+  startRenderTask();
   startupTime = millis();
   lazyUpdateTime = startupTime;
   lastClientCheckTimeout = startupTime;
@@ -304,13 +365,12 @@ void loop()
   handleSerialCommands();
 
 #if ENABLE_SIMULATOR
-  // Update simulator data if enabled - this overrides real data
-  updateSimulatorData();
+  // Simulator samples are written by the CAN/Serial task in place of real data
   
   // Reduce debug print frequency for simulator from 5s to 10s
   static uint32_t lastDebugPrint = 0;
   if (millis() - lastDebugPrint > 10000) {
-    Serial.printf("[DEBUG] Simulator running, current RPM: %d, mode: %d, commMode: %d\n", rpm, getSimulatorMode(), commMode);
+    Serial.printf("[DEBUG] Simulator running, current RPM: %d, mode: %d, commMode: %d\n", getChannelValue(DATA_SOURCE_RPM), getSimulatorMode(), commMode);
     lastDebugPrint = millis();
   }
 #endif
@@ -324,20 +384,10 @@ void loop()
   printDebugInfo();
 #endif
   
-  // Handle real data communication only if simulator is OFF
-#if ENABLE_SIMULATOR
-  if (getSimulatorMode() == SIMULATOR_MODE_OFF) {
-#endif
-
-#if ENABLE_SIMULATOR
-  }
-#endif
-
   // Update backlight brightness
   adjustBacklightAutomatically();
 
-  // Update display
-  drawData();
+  // Display is drawn by the render task on its own frame clock
 
   // Handle web server clients with power-saving logic
   // Reduce web server check frequency from every loop to every 10ms
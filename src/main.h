@@ -7,7 +7,7 @@ void updateDisplay();
 // Communication functions
 void handleCommunication();
 void handleCANCommunication();
-void handleSerialCommunication();
+void handleSerialCommunication(bool frameReceived);
 
 // Input handling
 void handleButtonInput();
@@ -30,12 +30,12 @@ uint8_t formatValue(char *buf, int32_t value, uint8_t decimal)
       len++;
       numLen++;
     }
-    for (uint8_t i = 0; i < decimal; i++)
+    // Shift the fractional digits and the terminator right to make room for '.'
+    for (uint8_t i = 0; i <= decimal; i++)
     {
       buf[len - i + 1] = buf[len - i];
     }
-    buf[len - decimal + 1] = '.';
-    buf[len + 2] = '\0';
+    buf[len - decimal] = '.';
     len++;
   }
   return len;
@@ -0,0 +1,26 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino core for the pure modules built by [env:native]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+unsigned long millis();
+unsigned long micros();
+
+struct HostSerial {
+  template <typename... Args>
+  int printf(const char *format, Args... args) {
+    return ::printf(format, args...);
+  }
+  void println(const char *text) {
+    ::puts(text);
+  }
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,48 @@
+#ifndef HOST_CHANNELS_H
+#define HOST_CHANNELS_H
+
+// Channel store and clock for host tests that link the CAN decoder. Included once
+// per test binary: channelInfo and scaleFixed come from the firmware's own
+// ChannelInfo.cpp, writeChannel/writeIndicator are recorded here.
+
+#include <chrono>
+#include "Arduino.h"
+#include "Channels.h"
+#include "../../src/ChannelInfo.cpp"
+
+HostSerial Serial;
+
+static unsigned long hostMillis = 0;
+unsigned long millis() { return hostMillis++; }
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int32_t hostValues[CHANNEL_COUNT];
+static uint32_t hostIndicators = 0;
+static uint32_t hostWrites = 0;
+
+void writeChannel(uint8_t channel, int32_t value, uint32_t nowMs) {
+  if (channel < CHANNEL_COUNT) {
+    hostValues[channel] = value;
+    hostWrites++;
+  }
+}
+
+void writeIndicator(uint8_t indicator, bool on) {
+  if (on) {
+    hostIndicators |= (1UL << indicator);
+  } else {
+    hostIndicators &= ~(1UL << indicator);
+  }
+}
+
+// One CAN frame of a host trace
+struct HostFrame {
+  uint32_t id;
+  uint8_t length;
+  uint8_t data[8];
+};
+
+#endif // HOST_CHANNELS_H
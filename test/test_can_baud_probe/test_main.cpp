@@ -0,0 +1,107 @@
+// Baud probe step function fed with event sequences recorded from listen-only
+// windows: F = valid frame, E = bus error, . = 10 ms receive timeout.
+// Run with: pio test -e native -f test_can_baud_probe
+
+#include <unity.h>
+#include "../../src/CANBaudProbe.cpp"
+
+// Haltech at 500k heard at 500k: engine frame every ~2 ms
+static const char *TRACE_MATCHED = "FFFFFFFFFFFF";
+// The same bus heard at 1M: stuff/form errors from the first bit
+static const char *TRACE_TOO_FAST = "EEEEEEEEEEEEEEEE";
+// Heard at 250k: an occasional frame happens to pass CRC between error bursts
+static const char *TRACE_TOO_SLOW = "EEFEEEFEEE";
+// Marginal termination: good frames with a stray error
+static const char *TRACE_NOISY = "FFEFFFFFFF...............";
+// Ignition off, bus silent
+static const char *TRACE_SILENT = "................";
+
+// Replays a trace 1 ms per event (10 ms for '.') and returns the final step
+static CANBaudStep replay(CANBaudSample &sample, uint32_t bitrate, const char *trace, uint16_t *eventsUsed) {
+  uint32_t nowMs = 1000;
+  beginCANBaudSample(sample, bitrate, nowMs);
+  CANBaudStep step = CAN_BAUD_STEP_LISTEN;
+  uint16_t used = 0;
+  for (const char *c = trace; *c && step == CAN_BAUD_STEP_LISTEN; c++) {
+    CANBaudEvent event = (*c == 'F') ? CAN_BAUD_EVENT_FRAME : (*c == 'E') ? CAN_BAUD_EVENT_ERROR : CAN_BAUD_EVENT_IDLE;
+    nowMs += (*c == '.') ? 10 : 1;
+    step = stepCANBaudSample(sample, event, nowMs);
+    used++;
+  }
+  if (eventsUsed) {
+    *eventsUsed = used;
+  }
+  return step;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_clean_traffic_stops_at_min_valid_frames(void) {
+  CANBaudSample sample;
+  uint16_t used;
+  TEST_ASSERT_EQUAL(CAN_BAUD_STEP_CONCLUSIVE, replay(sample, 500000, TRACE_MATCHED, &used));
+  TEST_ASSERT_EQUAL(CAN_BAUD_MIN_VALID_FRAMES, used);
+  TEST_ASSERT_EQUAL(CAN_BAUD_MIN_VALID_FRAMES, sample.validFrames);
+}
+
+static void test_error_burst_stops_at_max_errors(void) {
+  CANBaudSample sample;
+  uint16_t used;
+  TEST_ASSERT_EQUAL(CAN_BAUD_STEP_HOPELESS, replay(sample, 1000000, TRACE_TOO_FAST, &used));
+  TEST_ASSERT_EQUAL(CAN_BAUD_MAX_ERRORS, used);
+}
+
+static void test_lucky_frames_do_not_make_wrong_bitrate_conclusive(void) {
+  CANBaudSample sample;
+  TEST_ASSERT_EQUAL(CAN_BAUD_STEP_HOPELESS, replay(sample, 250000, TRACE_TOO_SLOW, NULL));
+  TEST_ASSERT_EQUAL(2, sample.validFrames);
+}
+
+static void test_stray_error_listens_until_window_closes(void) {
+  CANBaudSample sample;
+  TEST_ASSERT_EQUAL(CAN_BAUD_STEP_TIMEOUT, replay(sample, 500000, TRACE_NOISY, NULL));
+  TEST_ASSERT_EQUAL(9, sample.validFrames);
+  TEST_ASSERT_EQUAL(1, sample.errorFrames);
+}
+
+static void test_silent_bus_times_out_empty(void) {
+  CANBaudSample sample;
+  uint16_t used;
+  TEST_ASSERT_EQUAL(CAN_BAUD_STEP_TIMEOUT, replay(sample, 500000, TRACE_SILENT, &used));
+  TEST_ASSERT_EQUAL(CAN_BAUD_PROBE_WINDOW_MS / 10, used);
+  TEST_ASSERT_EQUAL(0, sample.validFrames);
+}
+
+static void test_events_past_window_are_not_counted(void) {
+  CANBaudSample sample;
+  beginCANBaudSample(sample, 500000, 0);
+  TEST_ASSERT_EQUAL(CAN_BAUD_STEP_TIMEOUT, stepCANBaudSample(sample, CAN_BAUD_EVENT_FRAME, CAN_BAUD_PROBE_WINDOW_MS));
+  TEST_ASSERT_EQUAL(0, sample.validFrames);
+}
+
+static void test_probe_run_selects_matched_bitrate(void) {
+  const uint32_t bitrates[] = {1000000, 500000, 250000};
+  const char *traces[] = {TRACE_TOO_FAST, TRACE_NOISY, TRACE_TOO_SLOW};
+  CANBaudSample samples[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    replay(samples[i], bitrates[i], traces[i], NULL);
+  }
+  // Nothing clean yet: the noisy 500k sample is not trusted
+  TEST_ASSERT_EQUAL(-1, selectCANBitrate(samples, 3));
+
+  replay(samples[1], 500000, TRACE_MATCHED, NULL);
+  TEST_ASSERT_EQUAL(1, selectCANBitrate(samples, 3));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_clean_traffic_stops_at_min_valid_frames);
+  RUN_TEST(test_error_burst_stops_at_max_errors);
+  RUN_TEST(test_lucky_frames_do_not_make_wrong_bitrate_conclusive);
+  RUN_TEST(test_stray_error_listens_until_window_closes);
+  RUN_TEST(test_silent_bus_times_out_empty);
+  RUN_TEST(test_events_past_window_are_not_counted);
+  RUN_TEST(test_probe_run_selects_matched_bitrate);
+  return UNITY_END();
+}
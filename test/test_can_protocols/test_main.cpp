@@ -0,0 +1,136 @@
+// Decode check and throughput per CAN protocol table, through the same
+// decodeCANFrame() path the firmware uses.
+// Run with: pio test -e native -f test_can_protocols
+
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include "HostChannels.h"
+#include "../../src/CANDecoder.cpp"
+#include "../../src/CANProtocols.cpp"
+
+#define BENCH_FRAMES 2000000
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// One frame per ID the protocol carries, payloads from a fixed LCG so runs compare
+static std::vector<HostFrame> buildProtocolTrace(uint8_t protocol, uint16_t variants) {
+  const CANProtocol &p = canProtocols[protocol];
+  std::vector<HostFrame> trace;
+  uint32_t seed = 12345;
+  for (uint16_t v = 0; v < variants; v++) {
+    uint16_t lastId = 0;
+    for (uint8_t i = 0; i < p.signalCount; i++) {
+      if (p.signals[i].id == lastId) {
+        continue;
+      }
+      lastId = p.signals[i].id;
+      HostFrame f = {lastId, 8, {0}};
+      for (uint8_t b = 0; b < 8; b++) {
+        seed = seed * 1103515245 + 12345;
+        f.data[b] = seed >> 16;
+      }
+      trace.push_back(f);
+    }
+  }
+  return trace;
+}
+
+static void decode(uint32_t id, const uint8_t *data) {
+  decodeCANFrame(id, data, 8);
+}
+
+static void test_haltech_known_frame(void) {
+  selectCANProtocol(CAN_PROTOCOL_HALTECH);
+  const uint8_t engine[8] = {0x0B, 0xB8, 0x03, 0xE8, 0x01, 0xF4, 0, 0};  // 3000 rpm, 100.0 kPa, 50.0 %
+  decode(0x360, engine);
+  TEST_ASSERT_EQUAL_INT32(3000, hostValues[DATA_SOURCE_RPM]);
+  TEST_ASSERT_EQUAL_INT32(1000, hostValues[DATA_SOURCE_MAP]);
+  TEST_ASSERT_EQUAL_INT32(500, hostValues[DATA_SOURCE_TPS]);
+}
+
+static void test_rusefi_known_frame(void) {
+  selectCANProtocol(CAN_PROTOCOL_RUSEFI);
+  const uint8_t base1[8] = {0xB8, 0x0B, 0xF4, 0x01, 0, 0, 88, 0};      // 3000 rpm, 10.00 deg, 88 km/h
+  decode(0x201, base1);
+  TEST_ASSERT_EQUAL_INT32(3000, hostValues[DATA_SOURCE_RPM]);
+  TEST_ASSERT_EQUAL_INT32(100, hostValues[DATA_SOURCE_ADV]);
+  TEST_ASSERT_EQUAL_INT32(880, hostValues[DATA_SOURCE_VSS]);
+  const uint8_t base3[8] = {0xB8, 0x0B, 130, 65, 0, 0, 0, 0};          // 100.0 kPa, CLT 90 C, IAT 25 C
+  decode(0x203, base3);
+  TEST_ASSERT_EQUAL_INT32(1000, hostValues[DATA_SOURCE_MAP]);
+  TEST_ASSERT_EQUAL_INT32(900, hostValues[DATA_SOURCE_COOLANT]);
+  TEST_ASSERT_EQUAL_INT32(250, hostValues[DATA_SOURCE_IAT]);
+}
+
+static void test_ms_dash_known_frame(void) {
+  selectCANProtocol(CAN_PROTOCOL_MS_DASH);
+  const uint8_t group0[8] = {0, 0, 0, 0, 0, 0, 0x0B, 0xB8};            // 3000 rpm
+  decode(0x5F0, group0);
+  TEST_ASSERT_EQUAL_INT32(3000, hostValues[DATA_SOURCE_RPM]);
+  const uint8_t group2[8] = {0, 0, 0x03, 0xE8, 0x03, 0x20, 0x07, 0x08}; // 100.0 kPa, MAT 80.0 F, CLT 180.0 F
+  decode(0x5F2, group2);
+  TEST_ASSERT_EQUAL_INT32(1000, hostValues[DATA_SOURCE_MAP]);
+  TEST_ASSERT_INT32_WITHIN(1, 267, hostValues[DATA_SOURCE_IAT]);
+  TEST_ASSERT_INT32_WITHIN(1, 822, hostValues[DATA_SOURCE_COOLANT]);
+}
+
+static void test_every_table_id_decodes(void) {
+  for (uint8_t protocol = 0; protocol < CAN_PROTOCOL_COUNT; protocol++) {
+    selectCANProtocol(protocol);
+    std::vector<HostFrame> trace = buildProtocolTrace(protocol, 1);
+    for (const HostFrame &frame : trace) {
+      TEST_ASSERT_TRUE(decodeCANFrame(frame.id, frame.data, frame.length));
+      TEST_ASSERT_TRUE(protocolCarriesId(protocol, frame.id));
+    }
+  }
+}
+
+// Frames/s and signals/s per protocol, plus the reject path for another protocol's IDs
+static void test_benchmark_protocols(void) {
+  for (uint8_t protocol = 0; protocol < CAN_PROTOCOL_COUNT; protocol++) {
+    selectCANProtocol(protocol);
+    std::vector<HostFrame> trace = buildProtocolTrace(protocol, 64);
+    std::vector<HostFrame> foreign = buildProtocolTrace((protocol + 1) % CAN_PROTOCOL_COUNT, 64);
+    uint32_t frames = 0;
+    uint32_t writesBefore = hostWrites;
+
+    auto start = std::chrono::steady_clock::now();
+    while (frames < BENCH_FRAMES) {
+      for (const HostFrame &frame : trace) {
+        decodeCANFrame(frame.id, frame.data, frame.length);
+      }
+      frames += trace.size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint32_t writes = hostWrites - writesBefore;
+
+    start = std::chrono::steady_clock::now();
+    uint32_t rejected = 0;
+    while (rejected < BENCH_FRAMES) {
+      for (const HostFrame &frame : foreign) {
+        decodeCANFrame(frame.id, frame.data, frame.length);
+      }
+      rejected += foreign.size();
+    }
+    double rejectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char message[160];
+    snprintf(message, sizeof(message), "%-8s %2u IDs %2u signals: %.2f Mframes/s, %.2f Mwrites/s, foreign IDs rejected at %.2f Mframes/s",
+             canProtocols[protocol].name, (unsigned)(trace.size() / 64), canProtocols[protocol].signalCount,
+             frames / seconds / 1e6, writes / seconds / 1e6, rejected / rejectSeconds / 1e6);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(seconds > 0 && rejectSeconds > 0);
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_haltech_known_frame);
+  RUN_TEST(test_rusefi_known_frame);
+  RUN_TEST(test_ms_dash_known_frame);
+  RUN_TEST(test_every_table_id_decodes);
+  RUN_TEST(test_benchmark_protocols);
+  return UNITY_END();
+}